@@ -0,0 +1,43 @@
+#pragma once
+
+#include <mwadaptorimaq.h>
+#include <Kinect.h>
+
+#include "BodyFrameData.h"
+#include "KinectAdapter.h"
+#include "KinectDeviceInfo.h"
+
+//Delivers body tracking. The skeletons are attached to each frame as
+//metadata, see BodyFrameData; the image is only a placeholder holding one
+//pixel per body, 255 while the body is tracked.
+class BodyAdapter :
+	public KinectAdapter<IBodyFrameSource>
+{
+public:
+	BodyAdapter(imaqkit::IEngine* engine,
+		const KinectDeviceInfo *deviceInfo,
+		const char* formatName);
+	~BodyAdapter();
+
+	//Driver information
+	virtual const char* getDriverDescription() const override;
+
+	//Device frame information
+	virtual imaqkit::frametypes::FRAMETYPE getFrameType() const override;
+	virtual int getMaxHeight() const override;
+	virtual int getMaxWidth() const override;
+	virtual int getNumberOfBands() const override;
+
+protected:
+	virtual unsigned int queryFrameSize() override;
+	virtual HRESULT copyFrameData(IBodyFrame *frame, BYTE *data, unsigned int size) override;
+	virtual bool writesFrameInPlace() const override;
+	virtual void getFrameMetadata(IBodyFrame *frame, FrameMetadata &metadata) override;
+	virtual bool deliversBodies() const override;
+	virtual void getFrameBodies(IBodyFrame *frame, BodyFrameData &bodies) override;
+
+private:
+	//Created by the first refresh and refreshed in place by every frame after
+	IBody *m_bodies[BodyFrameData::BODIES];
+	int m_trackedCount;
+};
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <mwadaptorimaq.h>
+#include <windows.h>
+#include <Kinect.h>
+
+//The bodies of one body frame in fixed storage. Filled on the capture thread
+//and attached to the engine frame as metadata on delivery, neither of which
+//allocates. Bodies that are not tracked are all zero.
+//
+//Metadata items, indexed by body first:
+//  BodyTracked          BODIES        1 for a tracked body
+//  BodyTrackingId       BODIES x 2    high, low 32 bits of the SDK's 64-bit
+//                                     tracking id, which a double cannot hold
+//  HandStates           BODIES x 2    left, right HandState
+//  JointPositions       BODIES x JOINTS x 3   camera space X, Y, Z in metres
+//  JointOrientations    BODIES x JOINTS x 4   quaternion x, y, z, w
+//  JointTrackingStates  BODIES x JOINTS       TrackingState
+class BodyFrameData
+{
+public:
+	static const int BODIES = BODY_COUNT;
+	static const int JOINTS = JointType_Count;
+
+	BodyFrameData();
+
+	void clear();
+	//Reads count bodies, as refreshed by IBodyFrame::GetAndRefreshBodyData.
+	void read(IBody *const *bodies, int count);
+	void attach(imaqkit::IAdaptorFrame *frame);
+
+	bool isTracked(int body) const;
+
+	double tracked[BODIES];
+	double trackingIds[BODIES][2];
+	double handStates[BODIES][2];
+	double positions[BODIES][JOINTS][3];
+	double orientations[BODIES][JOINTS][4];
+	double jointStates[BODIES][JOINTS];
+
+private:
+	//Row pointers into the arrays above, in the form addMetaItem takes
+	double *m_idRows[BODIES];
+	double *m_handRows[BODIES];
+	double *m_stateRows[BODIES];
+	double *m_positionRows[BODIES][JOINTS];
+	double **m_positionBodies[BODIES];
+	double *m_orientationRows[BODIES][JOINTS];
+	double **m_orientationBodies[BODIES];
+
+	//The row pointers point into this object
+	BodyFrameData(const BodyFrameData&);
+	BodyFrameData &operator=(const BodyFrameData&);
+};
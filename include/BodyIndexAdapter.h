@@ -0,0 +1,60 @@
+#pragma once
+
+#include <vector>
+
+#include <mwadaptorimaq.h>
+#include <Kinect.h>
+
+#include "KinectAdapter.h"
+#include "KinectDeviceInfo.h"
+
+//Delivers the body index frame, the index of the body each depth pixel
+//belongs to or 255 for none.
+//
+//The masked format instead delivers the depth frame taken at the same time
+//with every pixel outside a body cleared. Body indices are computed from
+//depth and arrive after it, so the adapter keeps the last two depth frames
+//of its own depth reader and picks the one with the matching timestamp.
+class BodyIndexAdapter :
+	public KinectAdapter<IBodyIndexFrameSource>
+{
+public:
+	BodyIndexAdapter(imaqkit::IEngine* engine,
+		const KinectDeviceInfo *deviceInfo,
+		const char* formatName);
+	~BodyIndexAdapter();
+
+	//Driver information
+	virtual const char* getDriverDescription() const override;
+
+	//Device frame information
+	virtual imaqkit::frametypes::FRAMETYPE getFrameType() const override;
+	virtual int getMaxHeight() const override;
+	virtual int getMaxWidth() const override;
+	virtual int getNumberOfBands() const override;
+
+	//Device capture control
+	virtual bool startCapture() override;
+	virtual bool stopCapture() override;
+
+protected:
+	virtual unsigned int queryFrameSize() override;
+	virtual HRESULT copyFrameData(IBodyIndexFrame *frame, BYTE *data, unsigned int size) override;
+	virtual bool writesFrameInPlace() const override;
+
+private:
+	static const int DEPTH_HISTORY = 2;
+
+	HRESULT copyMaskedDepth(IBodyIndexFrame *frame, BYTE *data);
+	void pollDepth();
+	const UINT16 *findDepth(TIMESPAN time) const;
+
+	bool m_masked;
+	IDepthFrameReader *m_depthReader;
+
+	//Most recent depth frames and their sensor times; m_latestDepth is the
+	//newest entry
+	std::vector<UINT16> m_depth[DEPTH_HISTORY];
+	TIMESPAN m_depthTimes[DEPTH_HISTORY];
+	int m_latestDepth;
+};
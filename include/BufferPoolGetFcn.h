@@ -0,0 +1,44 @@
+#pragma once
+
+#include <climits>
+#include <cstring>
+
+#include <mwadaptorimaq.h>
+
+#include "FrameBufferPool.h"
+#include "KinectDeviceProperties.h"
+
+//Reports the buffer pool statistics of an adaptor's sensor session. Reads
+//zero while the device is closed. The properties are ints, so larger values
+//read as INT_MAX.
+template <class Adaptor>
+class BufferPoolGetFcn :
+	public imaqkit::IPropCustomGetFcn
+{
+public:
+	BufferPoolGetFcn(Adaptor *adaptor) : m_adaptor(adaptor) {}
+
+	virtual void getValue(imaqkit::IPropInfo* propertyInfo, void* value) override {
+		size_t result = 0;
+
+		FrameBufferPool *pool = m_adaptor->getBufferPool();
+		if (pool != nullptr) {
+			const char *name = propertyInfo->getPropertyName();
+
+			if (strcmp(name, kinectprops::BUFFER_POOL_HITS) == 0) {
+				result = pool->getHitCount();
+			}
+			else if (strcmp(name, kinectprops::BUFFER_POOL_MISSES) == 0) {
+				result = pool->getMissCount();
+			}
+			else if (strcmp(name, kinectprops::BUFFER_POOL_BYTES_OUTSTANDING) == 0) {
+				result = pool->getBytesOutstanding();
+			}
+		}
+
+		*(reinterpret_cast<int*>(value)) = result > INT_MAX ? INT_MAX : static_cast<int>(result);
+	}
+
+private:
+	Adaptor *m_adaptor;
+};
@@ -1,13 +1,17 @@
 #pragma once
-#pragma once
+
+#include <vector>
 
 #include <mwadaptorimaq.h>
 #include <Kinect.h>
 
+#include "ColourConversion.h"
+#include "KinectAdapter.h"
 #include "KinectDeviceInfo.h"
+#include "RowBandPool.h"
 
 class ColourAdapter :
-	public imaqkit::IAdaptor
+	public KinectAdapter<IColorFrameSource>
 {
 public:
 	ColourAdapter(imaqkit::IEngine* engine,
@@ -17,11 +21,6 @@ public:
 
 	//Driver information
 	virtual const char* getDriverDescription() const override;
-	virtual const char* getDriverVersion() const override;
-
-	//Device control functions
-	virtual bool openDevice() override;
-	virtual bool closeDevice() override;
 
 	//Device frame information
 	virtual imaqkit::frametypes::FRAMETYPE getFrameType() const override;
@@ -29,36 +28,73 @@ public:
 	virtual int getMaxWidth() const override;
 	virtual int getNumberOfBands() const override;
 
-	virtual WAITABLE_HANDLE getFrameEvent();
-	IKinectSensor *getSensor() const;
-	IColorFrameSource *getSource() const;
-	IColorFrameReader *getReader() const;
-	unsigned int getFrameSize() const;
 	ColorImageFormat getFormat() const;
 
-	bool aquireFrame() const;
-	void notifyCaptureFinished();
+	//Moves the origin of YUY2 regions back to an even column, as pixel
+	//pairs share their chroma. getROI reports the region as moved, which is
+	//the region delivered.
+	virtual void getROI(int &originX, int &originY, int &width, int &height) const override;
+	virtual void setROI(const int originX, const int originY, const int width, const int height) override;
 
 	//Device capture control
 	virtual bool startCapture() override;
 	virtual bool stopCapture() override;
 
-private:
-	IKinectSensor *m_sensor;
-	IColorFrameSource *m_source;
-	IColorFrameReader *m_reader; 
+protected:
+	virtual unsigned int queryFrameSize() override;
+	virtual HRESULT copyFrameData(IColorFrame *frame, BYTE *data, unsigned int size) override;
+	virtual bool writesFrameInPlace() const override;
+	virtual void getFrameMetadata(IColorFrame *frame, FrameMetadata &metadata) override;
 
-	ColorImageFormat m_format;
-
-	static DWORD WINAPI aquireThread(void* param);
-	HANDLE m_aquireThread;
-	DWORD m_aquireThreadID;
+private:
+	class CopyRowsTask;
 
-	WAITABLE_HANDLE m_frameEvent;
+	//Converts or crops rows [first, last) of the region of interest
+	void copyRows(const BYTE *yuy2, int first, int last, BYTE *data) const;
+	HRESULT copyDemosaicFrame(IColorFrame *frame, BYTE *data);
+	HRESULT copyDepthFrame(BYTE *data);
 
-	unsigned int m_frameSize;
+	ColorImageFormat m_format;
 
-	bool m_aquireFrame;
-	bool m_captureFinished;
+	//RGB24 formats are converted by the adapter, downscaled by m_scale
+	bool m_rgb24;
+	int m_scale;
+	//Planar RGB24 keeps each channel in its own plane of the region
+	bool m_planar;
+	colourconversion::Matrix m_matrix;
+
+	//The demosaic format converts the SDK's Bayer mosaic to RGB24 here
+	//instead of in the engine. The edge-aware method fills the green plane
+	//first.
+	bool m_demosaic;
+	bool m_edgeAware;
+	std::vector<BYTE> m_mosaic;
+	std::vector<BYTE> m_green;
+
+	//The depth format delivers depth in millimetres rendered at colour
+	//resolution instead of colour. It reads the latest depth frame through
+	//its own reader for every colour frame.
+	bool m_depthOutput;
+	IDepthFrameReader *m_depthReader;
+	ICoordinateMapper *m_mapper;
+
+	//Shares the per-frame work of the formats written in place across bands
+	//of rows; recreated when the worker properties change
+	RowBandPool *m_workers;
+	int m_workerThreads;
+
+	//Latest depth frame, the colour position of each of its pixels and the
+	//colour rows each depth row spans
+	std::vector<UINT16> m_depth;
+	std::vector<ColorSpacePoint> m_colourPoints;
+	std::vector<float> m_rowTop;
+	std::vector<float> m_rowBottom;
+	TIMESPAN m_depthTime;
+	bool m_hasDepth;
+
+	//Region of interest as last set, the whole frame until then
+	int m_regionX;
+	int m_regionY;
+	int m_regionWidth;
+	int m_regionHeight;
 };
-
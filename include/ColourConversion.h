@@ -0,0 +1,89 @@
+#pragma once
+
+#include <windows.h>
+#include <Kinect.h>
+
+//Conversion kernels for the colour adapter. Sources are the sensor's native
+//YUY2 frames, or its Bayer mosaic; outputs are packed RGB24 in R-G-B order, or planar RGB24 with
+//planes of planeSize bytes in R, G, B order. YUY2 is taken as video range.
+namespace colourconversion {
+	enum Matrix { BT601, BT709 };
+
+	//Code paths of convertYuy2ToRgb24. AUTO_PATH takes AVX2 where the
+	//processor and OS support it and SSE2 otherwise; the others exist so the
+	//paths can be checked against each other.
+	enum ConversionPath { AUTO_PATH, SCALAR_PATH, SSE2_PATH, AVX2_PATH };
+
+	//YUV to RGB matrix as floats, and in Q13 fixed point for the vector
+	//paths of convertYuy2ToRgb24.
+	struct Coefficients {
+		float lumaScale;
+		float redFromV;
+		float greenFromU;
+		float greenFromV;
+		float blueFromU;
+
+		short fixedLumaScale;
+		short fixedRedFromV;
+		short fixedGreenFromU;
+		short fixedGreenFromV;
+		short fixedBlueFromU;
+	};
+
+	const Coefficients &getCoefficients(Matrix matrix);
+
+	bool hasAvx2();
+
+	//Converts the region of a full resolution frame pixel for pixel. Vector
+	//paths are within one step of the scalar path in each channel.
+	void convertYuy2ToRgb24(const BYTE *source, int sourceWidth, Matrix matrix,
+		int originX, int originY, int width, int height, BYTE *rgb,
+		ConversionPath path = AUTO_PATH);
+
+	//Same as convertYuy2ToRgb24, writing each row of the region into the
+	//three planes instead. The vector path is SSE2 only.
+	void convertYuy2ToPlanar(const BYTE *source, int sourceWidth, Matrix matrix,
+		int originX, int originY, int width, int height, size_t planeSize, BYTE *planes,
+		ConversionPath path = AUTO_PATH);
+
+	//AVX2 body of convertYuy2ToRgb24, kept in its own file so only it is
+	//built for AVX2. Converts pairs YUY2 pixel pairs, a multiple of 8.
+	void convertPairsAvx2(const BYTE *source, int pairs, const Coefficients &coefficients, BYTE *rgb);
+
+	//Averages each factor x factor block of source pixels into one RGB24
+	//pixel, converting after the averaging so each block is converted once.
+	//factor must be 2 or 4. The origin and size give the output region in
+	//downscaled pixels.
+	void downscaleYuy2ToRgb24(const BYTE *source, int sourceWidth, int factor, Matrix matrix,
+		int originX, int originY, int width, int height, BYTE *rgb);
+
+	void downscaleYuy2ToPlanar(const BYTE *source, int sourceWidth, int factor, Matrix matrix,
+		int originX, int originY, int width, int height, size_t planeSize, BYTE *planes);
+
+	//Bayer kernels for the GRBG mosaic of the BAYER formats: G R on even
+	//rows, B G on odd rows. Sites past the edges are mirrored. The vector
+	//paths are SSE2 and match the scalar path exactly.
+
+	//Averages the nearest sites of each missing channel.
+	void demosaicBilinear(const BYTE *mosaic, int mosaicWidth, int mosaicHeight,
+		int originX, int originY, int width, int height, BYTE *rgb,
+		ConversionPath path = AUTO_PATH);
+
+	//Fills rows [firstRow, lastRow) of a full frame green plane, taking
+	//green at red and blue sites along the direction of least change.
+	void interpolateGreen(const BYTE *mosaic, int mosaicWidth, int mosaicHeight,
+		int firstRow, int lastRow, BYTE *green, ConversionPath path = AUTO_PATH);
+
+	//Interpolates red and blue as differences from the green plane, which
+	//must hold the rows next to the region as well as those in it.
+	void demosaicEdgeAware(const BYTE *mosaic, const BYTE *green, int mosaicWidth, int mosaicHeight,
+		int originX, int originY, int width, int height, BYTE *rgb,
+		ConversionPath path = AUTO_PATH);
+
+	//Samples the source at the nearest pixel to each of count colour space
+	//points, as given by the coordinate mapper for depth pixels. Points
+	//outside the colour frame, including unmapped ones, give black. Always
+	//BT.601.
+	void gatherYuy2ToRgb24(const BYTE *source, int sourceWidth, int sourceHeight,
+		const ColorSpacePoint *points, int count, BYTE *rgb);
+}
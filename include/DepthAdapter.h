@@ -1,13 +1,15 @@
 #pragma once
-#pragma once
+
+#include <vector>
 
 #include <mwadaptorimaq.h>
 #include <Kinect.h>
 
+#include "KinectAdapter.h"
 #include "KinectDeviceInfo.h"
 
 class DepthAdapter :
-	public imaqkit::IAdaptor
+	public KinectAdapter<IDepthFrameSource>
 {
 public:
 	DepthAdapter(imaqkit::IEngine* engine,
@@ -17,11 +19,6 @@ public:
 
 	//Driver information
 	virtual const char* getDriverDescription() const override;
-	virtual const char* getDriverVersion() const override;
-
-	//Device control functions
-	virtual bool openDevice() override;
-	virtual bool closeDevice() override;
 
 	//Device frame information
 	virtual imaqkit::frametypes::FRAMETYPE getFrameType() const override;
@@ -29,33 +26,38 @@ public:
 	virtual int getMaxWidth() const override;
 	virtual int getNumberOfBands() const override;
 
-	virtual WAITABLE_HANDLE getFrameEvent();
-	IKinectSensor *getSensor() const;
-	IDepthFrameSource *getSource() const;
-	IDepthFrameReader *getReader() const;
-	unsigned int getFrameSize() const;
-
-	bool aquireFrame() const;
-	void notifyCaptureFinished();
-
-	//Device capture control
 	virtual bool startCapture() override;
-	virtual bool stopCapture() override;
 
-private:
-	IKinectSensor *m_sensor;
-	IDepthFrameSource *m_source;
-	IDepthFrameReader *m_reader; 
+protected:
+	virtual unsigned int queryFrameSize() override;
+	virtual HRESULT copyFrameData(IDepthFrame *frame, BYTE *data, unsigned int size) override;
+	virtual bool writesFrameInPlace() const override;
 
-	static DWORD WINAPI aquireThread(void* param);
-	HANDLE m_aquireThread;
-	DWORD m_aquireThreadID;
-
-	WAITABLE_HANDLE m_frameEvent;
-
-	unsigned int m_frameSize;
-
-	bool m_aquireFrame;
-	bool m_captureFinished;
+private:
+	const UINT16 *filterFrame(const UINT16 *depth);
+	HRESULT copyPointCloud(const UINT16 *depth, float *points);
+	HRESULT fetchRayTable();
+
+	enum DepthOutput { RAW_OUTPUT, METRES_OUTPUT, CLIPPED_OUTPUT, POINT_CLOUD_OUTPUT };
+	enum TemporalFilter { NO_FILTER, AVERAGE_FILTER, MEDIAN_FILTER, HOLD_FILTER };
+
+	DepthOutput m_output;
+	UINT16 m_clipMinimum;
+	UINT16 m_clipMaximum;
+
+	//The session's depth ray table, fetched once per capture so the capture
+	//thread does not take the session lock for every point cloud
+	const PointF *m_rays;
+	unsigned int m_rayCount;
+
+	//Temporal filter run over each whole frame before its conversion, and
+	//the state it carries from frame to frame
+	TemporalFilter m_filter;
+	int m_window;
+	int m_slot;
+	std::vector<UINT16> m_filtered;
+	std::vector<float> m_average;
+	std::vector<UINT16> m_history;
+	std::vector<UINT16> m_held;
+	std::vector<UINT16> m_heldAge;
 };
-
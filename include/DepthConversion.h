@@ -0,0 +1,81 @@
+#pragma once
+
+#include <windows.h>
+#include <Kinect.h>
+
+//Conversion kernels for the depth adapter. Sources are the sensor's 16-bit
+//depth in millimetres, where zero marks pixels without a reading.
+namespace depthconversion {
+	//Writes count depths as single precision metres; invalid pixels stay 0.
+	void toMetres(const UINT16 *depth, int count, float *metres);
+
+	//Maps [minimum, maximum] millimetres linearly onto [0, 255], clipping
+	//depths outside the range. Invalid pixels become 0.
+	void toClippedMono8(const UINT16 *depth, int count, UINT16 minimum, UINT16 maximum, BYTE *mono);
+
+	//Writes one camera space coordinate in metres for count depths: the ray
+	//X or Y scaled by the depth for axis 0 or 1, the depth itself for axis
+	//2. rays holds the depth pixels' entries of the camera space table.
+	void toCameraSpace(const UINT16 *depth, const PointF *rays, int count, int axis, float *coordinate);
+
+	//Keeps the depths of pixels that belong to a body and clears the rest.
+	//bodyIndex holds the body index frame's pixels, 255 where there is no
+	//body.
+	void applyBodyMask(const UINT16 *depth, const BYTE *bodyIndex, int count, UINT16 *masked);
+
+	//A depth frame with the colour position of every pixel, as returned by
+	//ICoordinateMapper::MapDepthFrameToColorSpace.
+	struct ColourMapping {
+		const UINT16 *depth;
+		const ColorSpacePoint *points;
+		//Colour rows spanned by each depth row, see colourRowBounds
+		const float *rowTop;
+		const float *rowBottom;
+		int width;
+		int height;
+	};
+
+	//Finds the lowest and highest colour row each depth row maps to, so the
+	//splatting can skip depth rows that miss a band entirely. Rows without a
+	//mapped pixel get an empty range.
+	void colourRowBounds(const ColorSpacePoint *points, int width, int height, float *top, float *bottom);
+
+	//Renders the depth frame at colour resolution. Every depth pixel covers
+	//the colour pixels between its own position and those of its right and
+	//lower neighbours; where splats overlap the nearest depth wins. Writes
+	//rows [firstRow, lastRow) of the width pixel wide region starting at
+	//colour pixel (originX, originY), so bands of rows can be rendered
+	//concurrently. Pixels no splat reaches are 0.
+	void splatToColour(const ColourMapping &mapping, int originX, int originY, int width,
+		int firstRow, int lastRow, UINT16 *colourDepth);
+
+	//Temporal filters, run on whole frames as they arrive. Each keeps its
+	//own per-pixel state between calls; zeroed state is a fresh start.
+
+	//Exponential moving average of each pixel's valid readings, weight
+	//being that of the newest. A pixel's first reading starts its average
+	//and invalid readings leave it alone.
+	void averageDepth(const UINT16 *depth, int count, float weight, float *average, UINT16 *filtered);
+
+	//The median history interleaves the frames in blocks of pixels: the
+	//window readings of one block are contiguous, one frame after another.
+	const int HISTORY_BLOCK = 8;
+	const int MAX_HISTORY_WINDOW = 9;
+
+	//Size of a median history in elements
+	size_t historySize(int count, int window);
+
+	//Stores depth as frame slot of the history, then writes each pixel's
+	//median over the valid readings among the window frames; the lower
+	//middle reading when there is an even number of them. Windows of 3, 5,
+	//7 and 9 frames have a vector path.
+	void medianDepth(const UINT16 *depth, int count, int window, int slot, UINT16 *history, UINT16 *filtered);
+
+	//Gives invalid pixels their last valid reading for up to maxAge frames.
+	//held and age keep the reading and how many frames ago it was taken.
+	void holdInvalidDepth(const UINT16 *depth, int count, int maxAge, UINT16 *held, UINT16 *age, UINT16 *filtered);
+
+	//Closes runs of at most maxGap invalid pixels lying between two readings
+	//with the farther of the two, which keeps foreground edges sharp.
+	void fillRowGaps(UINT16 *row, int width, int maxGap);
+}
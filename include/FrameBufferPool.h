@@ -0,0 +1,61 @@
+#pragma once
+
+#include <map>
+#include <vector>
+
+#include <mwadaptorimaq.h>
+#include <windows.h>
+
+//Recycles 64-byte aligned frame buffers. Requests are rounded up to a size
+//class so every format reuses the buffers released by earlier sessions of
+//the same format. Buffers of at least one large page are backed by large
+//pages when the account holds SeLockMemoryPrivilege, which the pool enables
+//for the process.
+//
+//Nothing trims the pool while the sensor session lives: it keeps the largest
+//ring of every format captured in the session until the session, and with
+//it the pool, is destroyed.
+class FrameBufferPool
+{
+public:
+	static const size_t ALIGNMENT = 64;
+	static const size_t SIZE_CLASS_GRANULARITY = 4096;
+
+	FrameBufferPool(bool useLargePages = true);
+	~FrameBufferPool();
+
+	BYTE *acquire(size_t size);
+	void release(BYTE *buffer);
+
+	//Frees every cached buffer not currently handed out.
+	void trim();
+
+	//Statistics are shared by every stream of the sensor.
+	unsigned int getHitCount() const;
+	unsigned int getMissCount() const;
+	size_t getBytesOutstanding() const;
+	size_t getBytesCached() const;
+
+private:
+	struct BufferHeader {
+		size_t sizeClass;
+		bool largePage;
+	};
+
+	BYTE *allocate(size_t sizeClass);
+	void freeBuffer(BYTE *buffer);
+
+	imaqkit::ICriticalSection *m_lock;
+	std::map<size_t, std::vector<BYTE*> > m_freeBuffers;
+
+	bool m_useLargePages;
+	size_t m_largePageSize;
+
+	unsigned int m_hits;
+	unsigned int m_misses;
+	size_t m_bytesOutstanding;
+	size_t m_bytesCached;
+
+	FrameBufferPool(const FrameBufferPool&);
+	FrameBufferPool &operator=(const FrameBufferPool&);
+};
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <Kinect.h>
+
+//Pairs frames from several streams by their sensor RelativeTime. Each stream
+//keeps a short history of recent frame times; callers store the frame data in
+//their own per-slot buffers and use the slot index returned by push.
+class FramePairing
+{
+public:
+	static const int MAX_STREAMS = 4;
+	static const int HISTORY = 4;
+
+	//Half a frame period at 30 fps, in 100 ns ticks
+	static const TIMESPAN DEFAULT_TOLERANCE = 166666;
+
+	FramePairing(int streamCount, TIMESPAN tolerance = DEFAULT_TOLERANCE);
+
+	void reset();
+
+	//Records a frame and returns the history slot it now occupies.
+	int push(int stream, TIMESPAN time);
+
+	//Returns the slot of stream closest to time, or -1 if none lies within
+	//the tolerance.
+	int find(int stream, TIMESPAN time) const;
+
+	//Matches every stream against the latest frame of the reference stream.
+	//Returns false unless all streams have a frame within the tolerance.
+	bool match(int referenceStream, int *slots) const;
+
+	//Like match, but the streams in the latestStreams bit mask only match
+	//with their latest frame, for callers that hold the data of that frame
+	//alone.
+	bool matchLatest(int referenceStream, unsigned int latestStreams, int *slots) const;
+
+	TIMESPAN getTime(int stream, int slot) const;
+	TIMESPAN getLatestTime(int stream) const;
+	int getLatestSlot(int stream) const;
+
+	unsigned int getMatchedCount() const;
+	unsigned int getUnmatchedCount() const;
+	void countMatch(bool matched);
+
+private:
+	int m_streamCount;
+	TIMESPAN m_tolerance;
+
+	TIMESPAN m_times[MAX_STREAMS][HISTORY];
+	int m_count[MAX_STREAMS];
+	int m_latest[MAX_STREAMS];
+
+	unsigned int m_matched;
+	unsigned int m_unmatched;
+};
@@ -0,0 +1,14 @@
+#pragma once
+
+#include <windows.h>
+
+//Crops the region of interest out of device frames, for the adapters that
+//write only the region into the engine frame.
+namespace frameregion {
+	//Copies the rows of the region found in source, a full width image of
+	//frameWidth pixels whose first row is row top of the device frame, to
+	//their place in data, which holds the whole region. Rows of source
+	//outside the region are skipped, so an image can be cropped in bands.
+	void copyRegion(const BYTE *source, int frameWidth, int bytesPerPixel, int top, int rows,
+		int originX, int originY, int width, int height, BYTE *data);
+}
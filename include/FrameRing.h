@@ -0,0 +1,285 @@
+#pragma once
+
+#include <atomic>
+#include <vector>
+
+#include <windows.h>
+
+//Bounded lock-free hand-off of preallocated frame slots from the capture
+//thread (producer) to the delivery thread (consumer).
+//
+//Slots never move; two index queues pass their ownership around. Free slots
+//flow from the consumer back to the producer, filled slots flow from the
+//producer to the consumer. When no slot is free the producer applies the
+//drop policy: it either gives up on the new frame, takes back the oldest
+//queued frame, or waits for the consumer to release a slot.
+template <class Slot>
+class FrameRing
+{
+public:
+	enum DropPolicy {
+		DROP_OLDEST = 1,
+		DROP_NEWEST,
+		BLOCK
+	};
+
+	FrameRing();
+	~FrameRing();
+
+	//Not thread safe; only call while neither thread is running.
+	void allocate(unsigned int depth);
+	void reset();
+
+	unsigned int getDepth() const;
+	Slot &getSlot(unsigned int index);
+
+	//Producer. Returns nullptr if the frame has to be dropped, or if
+	//stopEvent was signalled while blocking. replaced is set when the slot
+	//is a queued frame taken back under DROP_OLDEST, which the new frame
+	//then stands in for.
+	Slot *beginWrite(DropPolicy policy, HANDLE stopEvent, bool &replaced);
+	void commitWrite(Slot *slot);
+	//Hands a slot from beginWrite back without queueing it, along with the
+	//replaced flag beginWrite gave it.
+	void abortWrite(Slot *slot, bool replaced);
+
+	//Consumer. readEvent is signalled whenever a slot is queued.
+	HANDLE getReadEvent() const;
+	Slot *beginRead();
+	void endRead(Slot *slot);
+	//Counts a frame read from the ring that could not be delivered.
+	void countDropped();
+
+	unsigned int getDroppedCount() const;
+	unsigned int getHighWaterMark() const;
+
+private:
+	static const unsigned int NO_SLOT = 0xFFFFFFFF;
+
+	class IndexQueue
+	{
+	public:
+		void allocate(unsigned int capacity);
+		void reset();
+
+		void push(unsigned int value);
+		//Safe against one concurrent popper besides the owner.
+		bool pop(unsigned int &value);
+		unsigned int size() const;
+
+	private:
+		std::vector<unsigned int> m_entries;
+
+		std::atomic<unsigned int> m_head;
+		char m_padding[64];
+		std::atomic<unsigned int> m_tail;
+	};
+
+	unsigned int indexOf(const Slot *slot) const;
+
+	std::vector<Slot> m_slots;
+	IndexQueue m_free;
+	IndexQueue m_filled;
+
+	//Slot handed back by abortWrite, and whether it replaced a queued
+	//frame; only touched by the producer
+	unsigned int m_spare;
+	bool m_spareReplaced;
+
+	HANDLE m_readEvent;
+	HANDLE m_freeEvent;
+
+	std::atomic<unsigned int> m_dropped;
+	std::atomic<unsigned int> m_highWaterMark;
+
+	FrameRing(const FrameRing&);
+	FrameRing &operator=(const FrameRing&);
+};
+
+template <class Slot>
+void FrameRing<Slot>::IndexQueue::allocate(unsigned int capacity) {
+	m_entries.assign(capacity, 0);
+	reset();
+}
+
+template <class Slot>
+void FrameRing<Slot>::IndexQueue::reset() {
+	m_head.store(0);
+	m_tail.store(0);
+}
+
+template <class Slot>
+void FrameRing<Slot>::IndexQueue::push(unsigned int value) {
+	//There are never more indices than entries, so a push cannot overflow
+	unsigned int head = m_head.load(std::memory_order_relaxed);
+	m_entries[head % m_entries.size()] = value;
+	m_head.store(head + 1, std::memory_order_release);
+}
+
+template <class Slot>
+bool FrameRing<Slot>::IndexQueue::pop(unsigned int &value) {
+	unsigned int tail = m_tail.load(std::memory_order_acquire);
+
+	while (tail != m_head.load(std::memory_order_acquire)) {
+		value = m_entries[tail % m_entries.size()];
+		if (m_tail.compare_exchange_weak(tail, tail + 1, std::memory_order_acq_rel)) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+template <class Slot>
+unsigned int FrameRing<Slot>::IndexQueue::size() const {
+	return m_head.load(std::memory_order_acquire) - m_tail.load(std::memory_order_acquire);
+}
+
+template <class Slot>
+FrameRing<Slot>::FrameRing()
+	:m_spare(NO_SLOT),
+	m_spareReplaced(false),
+	m_readEvent(CreateEvent(NULL, FALSE, FALSE, NULL)),
+	m_freeEvent(CreateEvent(NULL, FALSE, FALSE, NULL)),
+	m_dropped(0),
+	m_highWaterMark(0) {}
+
+template <class Slot>
+FrameRing<Slot>::~FrameRing() {
+	CloseHandle(m_readEvent);
+	CloseHandle(m_freeEvent);
+}
+
+template <class Slot>
+void FrameRing<Slot>::allocate(unsigned int depth) {
+	m_slots.resize(depth);
+	m_free.allocate(depth);
+	m_filled.allocate(depth);
+	reset();
+}
+
+template <class Slot>
+void FrameRing<Slot>::reset() {
+	m_free.reset();
+	m_filled.reset();
+
+	for (unsigned int i = 0; i < m_slots.size(); i++) {
+		m_free.push(i);
+	}
+	m_spare = NO_SLOT;
+	m_spareReplaced = false;
+
+	ResetEvent(m_readEvent);
+	ResetEvent(m_freeEvent);
+
+	m_dropped.store(0);
+	m_highWaterMark.store(0);
+}
+
+template <class Slot>
+unsigned int FrameRing<Slot>::getDepth() const {
+	return static_cast<unsigned int>(m_slots.size());
+}
+
+template <class Slot>
+Slot &FrameRing<Slot>::getSlot(unsigned int index) {
+	return m_slots[index];
+}
+
+template <class Slot>
+unsigned int FrameRing<Slot>::indexOf(const Slot *slot) const {
+	return static_cast<unsigned int>(slot - &m_slots[0]);
+}
+
+template <class Slot>
+Slot *FrameRing<Slot>::beginWrite(DropPolicy policy, HANDLE stopEvent, bool &replaced) {
+	unsigned int index = m_spare;
+
+	replaced = false;
+	if (index != NO_SLOT) {
+		replaced = m_spareReplaced;
+		m_spare = NO_SLOT;
+		return &m_slots[index];
+	}
+
+	while (!m_free.pop(index)) {
+		switch (policy) {
+		case DROP_OLDEST:
+			if (m_filled.pop(index)) {
+				m_dropped++;
+				replaced = true;
+				return &m_slots[index];
+			}
+			//The consumer holds every slot
+			m_dropped++;
+			return nullptr;
+
+		case BLOCK: {
+			HANDLE handles[] = { m_freeEvent, stopEvent };
+			if (WaitForMultipleObjects(2, handles, FALSE, INFINITE) != WAIT_OBJECT_0) {
+				return nullptr;
+			}
+			break;
+		}
+
+		default:
+			m_dropped++;
+			return nullptr;
+		}
+	}
+
+	return &m_slots[index];
+}
+
+template <class Slot>
+void FrameRing<Slot>::commitWrite(Slot *slot) {
+	m_filled.push(indexOf(slot));
+
+	unsigned int queued = m_filled.size();
+	if (queued > m_highWaterMark.load(std::memory_order_relaxed)) {
+		m_highWaterMark.store(queued, std::memory_order_relaxed);
+	}
+
+	SetEvent(m_readEvent);
+}
+
+template <class Slot>
+void FrameRing<Slot>::abortWrite(Slot *slot, bool replaced) {
+	m_spare = indexOf(slot);
+	m_spareReplaced = replaced;
+}
+
+template <class Slot>
+HANDLE FrameRing<Slot>::getReadEvent() const {
+	return m_readEvent;
+}
+
+template <class Slot>
+Slot *FrameRing<Slot>::beginRead() {
+	unsigned int index;
+	if (!m_filled.pop(index)) {
+		return nullptr;
+	}
+	return &m_slots[index];
+}
+
+template <class Slot>
+void FrameRing<Slot>::endRead(Slot *slot) {
+	m_free.push(indexOf(slot));
+	SetEvent(m_freeEvent);
+}
+
+template <class Slot>
+void FrameRing<Slot>::countDropped() {
+	m_dropped++;
+}
+
+template <class Slot>
+unsigned int FrameRing<Slot>::getDroppedCount() const {
+	return m_dropped.load();
+}
+
+template <class Slot>
+unsigned int FrameRing<Slot>::getHighWaterMark() const {
+	return m_highWaterMark.load();
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <windows.h>
+
+//Kernels fusing the short and long exposure infrared frames into one high
+//dynamic range image. Both exposures are 16-bit intensities of the same
+//pixels; the long exposure is brighter by an unknown ratio and saturates
+//first.
+namespace infraredconversion {
+	//Estimates how much brighter the long exposure is, from the pixels that
+	//are well exposed in both. Returns previous if too few pixels qualify.
+	float exposureRatio(const UINT16 *shortExposure, const UINT16 *longExposure, int count, float previous);
+
+	//Merges count pixels into long exposure units. Below the blend range the
+	//long exposure is used as is; towards saturation it fades into the short
+	//exposure scaled by ratio, so bright pixels can exceed 65535.
+	void mergeExposures(const UINT16 *shortExposure, const UINT16 *longExposure, int count,
+		float ratio, float *hdr);
+
+	//As mergeExposures, rounded to 16 bits. Values up to the blend range
+	//keep the long exposure's units and precision; above it they are
+	//compressed linearly so that 65535 times ratio, the brightest merged
+	//value, maps to 65535.
+	void mergeExposures(const UINT16 *shortExposure, const UINT16 *longExposure, int count,
+		float ratio, UINT16 *hdr);
+}
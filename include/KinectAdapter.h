@@ -0,0 +1,747 @@
+#pragma once
+
+#include <mwadaptorimaq.h>
+#include <Kinect.h>
+
+#include "BufferPoolGetFcn.h"
+#include "FrameBufferPool.h"
+#include "FrameRegion.h"
+#include "FrameRing.h"
+#include "KinectDeviceInfo.h"
+#include "KinectDeviceProperties.h"
+#include "KinectFrameSlot.h"
+#include "KinectSensorSession.h"
+#include "KinectSourceTraits.h"
+
+//Acquisition engine shared by every Kinect stream. Owns the sensor
+//resources, the acquisition threads, the frame buffers and the frame timing;
+//the per-stream adapters only describe their output format.
+//
+//A capture thread copies frames out of the SDK into a ring of preallocated
+//slots and a delivery thread hands them to the engine, so a slow engine
+//never holds up reading the next frame.
+template <class Source>
+class KinectAdapter :
+	public imaqkit::IAdaptor
+{
+public:
+	typedef KinectSourceTraits<Source> Traits;
+	typedef typename Traits::Reader Reader;
+	typedef typename Traits::Frame Frame;
+	typedef FrameRing<KinectFrameSlot> Ring;
+
+	KinectAdapter(imaqkit::IEngine* engine,
+		const KinectDeviceInfo *deviceInfo);
+	virtual ~KinectAdapter();
+
+	//Driver information
+	virtual const char* getDriverVersion() const override;
+
+	//Device control functions
+	virtual bool openDevice() override;
+	virtual bool closeDevice() override;
+
+	IKinectSensor *getSensor() const;
+	//nullptr while the device is closed.
+	KinectSensorSession *getSession() const;
+	Source *getSource() const;
+	Reader *getReader() const;
+	unsigned int getFrameSize() const;
+	//nullptr while the device is closed.
+	FrameBufferPool *getBufferPool() const;
+
+	unsigned int getDroppedFrameCount() const;
+	unsigned int getQueueHighWaterMark() const;
+
+	//Device capture control
+	virtual bool startCapture() override;
+	virtual bool stopCapture() override;
+
+protected:
+	//Size in bytes of the buffer handed to copyFrameData.
+	virtual unsigned int queryFrameSize();
+	virtual HRESULT openReader(Source *source, Reader **reader);
+	//Fills the frame buffer. A failed result drops the frame.
+	virtual HRESULT copyFrameData(Frame *frame, BYTE *data, unsigned int size);
+	//When true the buffer handed to copyFrameData is the image of the engine
+	//frame itself, saving the copy made by setImage on delivery. The image
+	//only covers the region of interest, see copyRegion.
+	virtual bool writesFrameInPlace() const;
+	//Sensor time of the frame. Also queried for frames skipped by the grab
+	//interval, which never reach copyFrameData.
+	virtual HRESULT getRelativeTime(Frame *frame, TIMESPAN *time);
+	//Called on the capture thread right after a successful copyFrameData,
+	//while the frame is still held. Must not allocate.
+	virtual void getFrameMetadata(Frame *frame, FrameMetadata &metadata);
+	//When true every ring slot carries a BodyFrameData, filled by
+	//getFrameBodies and attached to the frame as metadata on delivery.
+	virtual bool deliversBodies() const;
+	//Called on the capture thread after getFrameMetadata. Must not allocate.
+	virtual void getFrameBodies(Frame *frame, BodyFrameData &bodies);
+
+	//Stops the capture and delivery threads and waits for them to exit. The
+	//threads call the overrides and read the members of the derived
+	//adapter, so every derived destructor calls this before it releases
+	//anything.
+	void stopAndJoin();
+
+	//Region of interest of the running capture, in device frame pixels.
+	void getRegion(int &originX, int &originY, int &width, int &height) const;
+	//Copies the part of the region of interest found in source, a full
+	//width image whose first row is row top of the device frame.
+	void copyRegion(const BYTE *source, int top, int rows, BYTE *data) const;
+
+private:
+	void releaseDevice();
+	bool allocateRing(unsigned int depth);
+	void releaseRing();
+	//nullptr if the engine has no frame to write into.
+	BYTE *getSlotBuffer(KinectFrameSlot *slot, unsigned int &size);
+	void releaseSlotFrames();
+
+	static DWORD WINAPI aquireThread(void* param);
+	void aquireFrames();
+
+	static DWORD WINAPI deliverThread(void* param);
+	void deliverFrames();
+	void deliverFrame(KinectFrameSlot *slot);
+
+	IKinectSensor *m_sensor;
+	//Tells this stream apart on the session's clock
+	int m_frameSourceType;
+	KinectSensorSession *m_session;
+	Source *m_source;
+	Reader *m_reader;
+
+	HANDLE m_aquireThread;
+	DWORD m_aquireThreadID;
+
+	WAITABLE_HANDLE m_frameEvent;
+
+	HANDLE m_deliverThread;
+
+	unsigned int m_frameSize;
+	unsigned int m_bytesPerPixel;
+
+	//Read from getROI when the capture starts
+	int m_roiX;
+	int m_roiY;
+	int m_roiWidth;
+	int m_roiHeight;
+
+	Ring m_ring;
+	typename Ring::DropPolicy m_dropPolicy;
+
+	//Frames read from the SDK since the capture started; capture thread only
+	unsigned int m_sequence;
+	//Ring drop count at the last delivery; delivery thread only
+	unsigned int m_deliveredDropCount;
+
+	//Manual reset events; set by stopCapture and by the acquisition thread
+	//once it has left the frame loop.
+	HANDLE m_stopEvent;
+	HANDLE m_captureFinishedEvent;
+};
+
+template <class Source>
+KinectAdapter<Source>::KinectAdapter(imaqkit::IEngine* engine,
+	const KinectDeviceInfo *deviceInfo)
+	:imaqkit::IAdaptor(engine),
+	m_sensor(deviceInfo->getDevice()),
+	m_frameSourceType(deviceInfo->getFrameSourceType()),
+	m_session(nullptr),
+	m_source(nullptr),
+	m_reader(nullptr),
+	m_aquireThread(NULL),
+	m_aquireThreadID(0),
+	m_frameEvent(),
+	m_deliverThread(NULL),
+	m_frameSize(0),
+	m_bytesPerPixel(0),
+	m_roiX(0),
+	m_roiY(0),
+	m_roiWidth(0),
+	m_roiHeight(0),
+	m_dropPolicy(Ring::DROP_OLDEST),
+	m_sequence(0),
+	m_deliveredDropCount(0),
+	m_stopEvent(CreateEvent(NULL, TRUE, FALSE, NULL)),
+	m_captureFinishedEvent(CreateEvent(NULL, TRUE, TRUE, NULL)) {
+
+	imaqkit::IPropContainer *props = getEngine()->getAdaptorPropContainer();
+	props->setCustomGetFcn(kinectprops::BUFFER_POOL_HITS, new BufferPoolGetFcn<KinectAdapter>(this));
+	props->setCustomGetFcn(kinectprops::BUFFER_POOL_MISSES, new BufferPoolGetFcn<KinectAdapter>(this));
+	props->setCustomGetFcn(kinectprops::BUFFER_POOL_BYTES_OUTSTANDING, new BufferPoolGetFcn<KinectAdapter>(this));
+}
+
+template <class Source>
+KinectAdapter<Source>::~KinectAdapter() {
+	releaseDevice();
+
+	CloseHandle(m_stopEvent);
+	CloseHandle(m_captureFinishedEvent);
+}
+
+template <class Source>
+const char* KinectAdapter<Source>::getDriverVersion() const {
+	return "0.0.1";
+}
+
+template <class Source>
+IKinectSensor *KinectAdapter<Source>::getSensor() const {
+	return m_sensor;
+}
+
+template <class Source>
+KinectSensorSession *KinectAdapter<Source>::getSession() const {
+	return m_session;
+}
+
+template <class Source>
+Source *KinectAdapter<Source>::getSource() const {
+	return m_source;
+}
+
+template <class Source>
+typename KinectAdapter<Source>::Reader *KinectAdapter<Source>::getReader() const {
+	return m_reader;
+}
+
+template <class Source>
+unsigned int KinectAdapter<Source>::getFrameSize() const {
+	return m_frameSize;
+}
+
+template <class Source>
+FrameBufferPool *KinectAdapter<Source>::getBufferPool() const {
+	return m_session != nullptr ? &m_session->getBufferPool() : nullptr;
+}
+
+template <class Source>
+unsigned int KinectAdapter<Source>::getDroppedFrameCount() const {
+	return m_ring.getDroppedCount();
+}
+
+template <class Source>
+unsigned int KinectAdapter<Source>::getQueueHighWaterMark() const {
+	return m_ring.getHighWaterMark();
+}
+
+template <class Source>
+unsigned int KinectAdapter<Source>::queryFrameSize() {
+	IFrameDescription *desc;
+	if (FAILED(Traits::getFrameDescription(m_source, &desc))) {
+		return 0;
+	}
+
+	unsigned int bpp, lip;
+	desc->get_BytesPerPixel(&bpp);
+	desc->get_LengthInPixels(&lip);
+	desc->Release();
+
+	return bpp * lip;
+}
+
+template <class Source>
+HRESULT KinectAdapter<Source>::openReader(Source *source, Reader **reader) {
+	return Traits::openReader(source, reader);
+}
+
+template <class Source>
+HRESULT KinectAdapter<Source>::copyFrameData(Frame *frame, BYTE *data, unsigned int size) {
+	if (!writesFrameInPlace()) {
+		return Traits::copyFrameData(frame, data, size);
+	}
+
+	BYTE *buffer;
+	unsigned int capacity;
+	HRESULT hr = Traits::accessFrameData(frame, &buffer, &capacity);
+	if (FAILED(hr)) {
+		return hr;
+	}
+	if (capacity < m_frameSize) {
+		return E_UNEXPECTED;
+	}
+
+	copyRegion(buffer, 0, getMaxHeight(), data);
+	return S_OK;
+}
+
+template <class Source>
+HRESULT KinectAdapter<Source>::getRelativeTime(Frame *frame, TIMESPAN *time) {
+	return Traits::getRelativeTime(frame, time);
+}
+
+template <class Source>
+void KinectAdapter<Source>::getFrameMetadata(Frame *frame, FrameMetadata &metadata) {}
+
+template <class Source>
+bool KinectAdapter<Source>::deliversBodies() const {
+	return false;
+}
+
+template <class Source>
+void KinectAdapter<Source>::getFrameBodies(Frame *frame, BodyFrameData &bodies) {}
+
+template <class Source>
+bool KinectAdapter<Source>::writesFrameInPlace() const {
+	return false;
+}
+
+template <class Source>
+void KinectAdapter<Source>::getRegion(int &originX, int &originY, int &width, int &height) const {
+	originX = m_roiX;
+	originY = m_roiY;
+	width = m_roiWidth;
+	height = m_roiHeight;
+}
+
+template <class Source>
+void KinectAdapter<Source>::copyRegion(const BYTE *source, int top, int rows, BYTE *data) const {
+	frameregion::copyRegion(source, getMaxWidth(), m_bytesPerPixel, top, rows,
+		m_roiX, m_roiY, m_roiWidth, m_roiHeight, data);
+}
+
+template <class Source>
+bool KinectAdapter<Source>::allocateRing(unsigned int depth) {
+	releaseRing();
+
+	FrameBufferPool &pool = m_session->getBufferPool();
+
+	m_ring.allocate(depth);
+	if (deliversBodies()) {
+		for (unsigned int i = 0; i < depth; i++) {
+			m_ring.getSlot(i).bodies = new BodyFrameData();
+		}
+	}
+	if (writesFrameInPlace()) {
+		return true;
+	}
+
+	for (unsigned int i = 0; i < depth; i++) {
+		m_ring.getSlot(i).data = pool.acquire(m_frameSize);
+		if (m_ring.getSlot(i).data == nullptr) {
+			releaseRing();
+			return false;
+		}
+	}
+	return true;
+}
+
+template <class Source>
+void KinectAdapter<Source>::releaseRing() {
+	for (unsigned int i = 0; i < m_ring.getDepth(); i++) {
+		KinectFrameSlot &slot = m_ring.getSlot(i);
+
+		m_session->getBufferPool().release(slot.data);
+		slot.data = nullptr;
+
+		delete slot.bodies;
+		slot.bodies = nullptr;
+	}
+	releaseSlotFrames();
+	m_ring.allocate(0);
+}
+
+template <class Source>
+BYTE *KinectAdapter<Source>::getSlotBuffer(KinectFrameSlot *slot, unsigned int &size) {
+	if (!writesFrameInPlace()) {
+		size = m_frameSize;
+		return slot->data;
+	}
+
+	//A slot taken back under DropOldest still holds its undelivered frame
+	if (slot->frame == nullptr) {
+		slot->frame = getEngine()->makeFrame(getFrameType(), m_roiWidth, m_roiHeight);
+		if (slot->frame == nullptr) {
+			return nullptr;
+		}
+	}
+	size = m_roiWidth * m_roiHeight * m_bytesPerPixel;
+	return static_cast<BYTE*>(slot->frame->getImage());
+}
+
+template <class Source>
+void KinectAdapter<Source>::releaseSlotFrames() {
+	for (unsigned int i = 0; i < m_ring.getDepth(); i++) {
+		KinectFrameSlot &slot = m_ring.getSlot(i);
+
+		if (slot.frame != nullptr) {
+			slot.frame->destroy();
+			slot.frame = nullptr;
+		}
+	}
+}
+
+template <class Source>
+bool KinectAdapter<Source>::openDevice() {
+
+	if (isOpen()) {
+		return true;
+	}
+
+	m_session = KinectSensorSession::acquire(m_sensor);
+	if (m_session == nullptr) {
+		imaqkit::adaptorError(this, "KinectAdapter:openDevice", "Unable to open kinect device.");
+		return false;
+	}
+
+	if (FAILED(Traits::getSource(m_sensor, &m_source))) {
+		imaqkit::adaptorError(this, "KinectAdapter:openDevice", "Unable to get %s frame source from kinect device.", Traits::name());
+		m_source = nullptr;
+		releaseDevice();
+		return false;
+	}
+
+	m_frameSize = queryFrameSize();
+	if (m_frameSize == 0) {
+		imaqkit::adaptorError(this, "KinectAdapter:openDevice", "Unable to get %s frame description.", Traits::name());
+		releaseDevice();
+		return false;
+	}
+	m_bytesPerPixel = m_frameSize / (getMaxWidth() * getMaxHeight());
+
+	if (FAILED(openReader(m_source, &m_reader))) {
+		imaqkit::adaptorError(this, "KinectAdapter:openDevice", "Unable to get frame reader from %s source.", Traits::name());
+		m_reader = nullptr;
+		releaseDevice();
+		return false;
+	}
+
+	m_aquireThread = CreateThread(NULL, 0, aquireThread, this, 0, &m_aquireThreadID);
+	if (m_aquireThread == NULL) {
+		releaseDevice();
+		return false;
+	}
+
+	while (PostThreadMessage(m_aquireThreadID, WM_USER + 1, 0, 0) == 0)
+		Sleep(1);
+
+	return true;
+}
+
+template <class Source>
+DWORD WINAPI KinectAdapter<Source>::aquireThread(void* param) {
+	KinectAdapter *adaptor = reinterpret_cast<KinectAdapter*>(param);
+
+	MSG msg;
+
+	while (GetMessage(&msg, NULL, 0, 0) > 0) {
+		switch (msg.message) {
+		case WM_USER:
+			adaptor->aquireFrames();
+			SetEvent(adaptor->m_captureFinishedEvent);
+			break;
+
+		default:
+			break;
+		}
+	}
+	return 0;
+}
+
+template <class Source>
+void KinectAdapter<Source>::aquireFrames() {
+	HANDLE handles[] = { reinterpret_cast <HANDLE>(m_frameEvent), m_stopEvent };
+
+	while (isAcquisitionNotComplete()) {
+		DWORD idx = WaitForMultipleObjects(2, handles, FALSE, INFINITE);
+		if (idx != WAIT_OBJECT_0) {
+			break;
+		}
+
+		typename Traits::ArrivedEventArgs *args;
+		if (FAILED(Traits::getEventData(m_reader, m_frameEvent, &args))) {
+			imaqkit::adaptorWarn("KinectAdapter:aquire", "Unable to aquire event data.");
+			continue;
+		}
+
+		//Arrival time of the frame, before any copy latency
+		double arrivalTime = imaqkit::getCurrentTime();
+
+		typename Traits::FrameReference *frameRef;
+		args->get_FrameReference(&frameRef);
+
+		Frame *frame;
+		HRESULT hr = frameRef->AcquireFrame(&frame);
+
+		//Frames the engine would discard for the grab interval are only
+		//timed, never copied
+		bool sendFrame = isSendFrame();
+
+		KinectFrameSlot *slot = nullptr;
+		bool replaced = false;
+		if (SUCCEEDED(hr)) {
+			if (sendFrame) {
+				slot = m_ring.beginWrite(m_dropPolicy, m_stopEvent, replaced);
+
+				if (slot != nullptr) {
+					unsigned int size;
+					BYTE *data = getSlotBuffer(slot, size);
+					hr = data != nullptr ? copyFrameData(frame, data, size) : E_OUTOFMEMORY;
+				}
+			}
+
+			if (SUCCEEDED(hr)) {
+				TIMESPAN relativeTime;
+				double time = arrivalTime;
+
+				if (SUCCEEDED(getRelativeTime(frame, &relativeTime))) {
+					time = m_session->getClock().update(m_frameSourceType, relativeTime, arrivalTime);
+				}
+				else {
+					relativeTime = 0;
+				}
+
+				if (slot != nullptr) {
+					slot->time = time;
+					slot->arrivalTime = arrivalTime;
+					slot->relativeTime = relativeTime;
+
+					slot->metadata.clear();
+					slot->metadata.add("RelativeTime", static_cast<double>(relativeTime));
+					slot->metadata.add("SequenceNumber", static_cast<double>(m_sequence));
+					getFrameMetadata(frame, slot->metadata);
+
+					if (slot->bodies != nullptr) {
+						getFrameBodies(frame, *slot->bodies);
+					}
+				}
+			}
+			m_sequence++;
+			frame->Release();
+		}
+
+		frameRef->Release();
+		args->Release();
+
+		//The frame expired before it could be read, was rejected, or had
+		//nowhere to go
+		if (FAILED(hr)) {
+			if (slot != nullptr) {
+				m_ring.abortWrite(slot, replaced);
+			}
+			continue;
+		}
+
+		//Only frames that reach the engine, or that the grab interval skips,
+		//are counted: a dropped frame is never counted, whichever policy
+		//dropped it
+		if (sendFrame) {
+			//No slot was available under the drop policy
+			if (slot == nullptr) {
+				continue;
+			}
+			m_ring.commitWrite(slot);
+
+			//The frame takes the place of a queued frame that was counted
+			//when it was written
+			if (replaced) {
+				continue;
+			}
+		}
+
+		incrementFrameCount();
+	}
+}
+
+template <class Source>
+DWORD WINAPI KinectAdapter<Source>::deliverThread(void* param) {
+	KinectAdapter *adaptor = reinterpret_cast<KinectAdapter*>(param);
+
+	adaptor->deliverFrames();
+	return 0;
+}
+
+template <class Source>
+void KinectAdapter<Source>::deliverFrames() {
+	HANDLE handles[] = { m_ring.getReadEvent(), m_stopEvent };
+
+	for (;;) {
+		KinectFrameSlot *slot;
+		while ((slot = m_ring.beginRead()) != nullptr) {
+			deliverFrame(slot);
+			m_ring.endRead(slot);
+		}
+
+		if (WaitForMultipleObjects(2, handles, FALSE, INFINITE) != WAIT_OBJECT_0) {
+			break;
+		}
+	}
+}
+
+template <class Source>
+void KinectAdapter<Source>::deliverFrame(KinectFrameSlot *slot) {
+	imaqkit::IAdaptorFrame *outFrame = slot->frame;
+	slot->frame = nullptr;
+
+	if (outFrame == nullptr) {
+		imaqkit::frametypes::FRAMETYPE frameType = getFrameType();
+		int imWidth = getMaxWidth();
+		int imHeight = getMaxHeight();
+
+		outFrame = getEngine()->makeFrame(frameType, m_roiWidth, m_roiHeight);
+		//The slot goes back to the ring with the frame dropped
+		if (outFrame == nullptr) {
+			m_ring.countDropped();
+			return;
+		}
+
+		outFrame->setImage(slot->data, imWidth, imHeight, m_roiX, m_roiY);
+	}
+
+	outFrame->setTime(slot->time);
+
+	for (int i = 0; i < slot->metadata.count; i++) {
+		outFrame->addMetaItem(slot->metadata.names[i], slot->metadata.values[i]);
+	}
+	if (slot->bodies != nullptr) {
+		slot->bodies->attach(outFrame);
+	}
+
+	unsigned int dropped = m_ring.getDroppedCount();
+	outFrame->addMetaItem("DroppedFrames", static_cast<double>(dropped));
+	outFrame->addMetaItem("DroppedSinceLast", static_cast<double>(dropped - m_deliveredDropCount));
+	outFrame->addMetaItem("QueueHighWaterMark", static_cast<double>(m_ring.getHighWaterMark()));
+	m_deliveredDropCount = dropped;
+
+	//Seconds from the frame's arrival to its hand-off to the engine
+	outFrame->addMetaItem("PipelineLatency", imaqkit::getCurrentTime() - slot->arrivalTime);
+
+	getEngine()->receiveFrame(outFrame);
+}
+
+template <class Source>
+void KinectAdapter<Source>::stopAndJoin() {
+	SetEvent(m_stopEvent);
+
+	//Both threads leave their waits on the stop event, and what they use is
+	//freed once this returns, so they are waited for without a timeout
+	if (m_deliverThread) {
+		WaitForSingleObject(m_deliverThread, INFINITE);
+
+		CloseHandle(m_deliverThread);
+		m_deliverThread = NULL;
+	}
+
+	if (m_aquireThread) {
+		PostThreadMessage(m_aquireThreadID, WM_QUIT, 0, 0);
+
+		WaitForSingleObject(m_aquireThread, INFINITE);
+
+		CloseHandle(m_aquireThread);
+		m_aquireThread = NULL;
+	}
+}
+
+template <class Source>
+void KinectAdapter<Source>::releaseDevice() {
+	stopAndJoin();
+
+	if (m_reader) {
+		m_reader->Release();
+		m_reader = nullptr;
+	}
+
+	if (m_source) {
+		m_source->Release();
+		m_source = nullptr;
+	}
+
+	releaseRing();
+	m_frameSize = 0;
+
+	KinectSensorSession::release(m_session);
+	m_session = nullptr;
+}
+
+template <class Source>
+bool KinectAdapter<Source>::closeDevice() {
+
+	if (!isOpen()) {
+		return true;
+	}
+
+	releaseDevice();
+
+	return true;
+}
+
+template <class Source>
+bool KinectAdapter<Source>::startCapture() {
+
+	if (!isOpen()) {
+		return false;
+	}
+
+	if (isAcquiring()) {
+		return true;
+	}
+
+	imaqkit::IPropContainer *props = getEngine()->getAdaptorPropContainer();
+
+	unsigned int depth = props->getPropValueAsInt(kinectprops::FRAME_QUEUE_DEPTH);
+	if (depth != m_ring.getDepth()) {
+		if (!allocateRing(depth)) {
+			imaqkit::adaptorError(this, "KinectAdapter:startCapture", "Unable to allocate %u frame buffers.", depth);
+			return false;
+		}
+	}
+	else {
+		m_ring.reset();
+	}
+	m_dropPolicy = static_cast<typename Ring::DropPolicy>(props->getPropValueAsInt(kinectprops::FRAME_DROP_POLICY));
+	m_sequence = 0;
+	m_deliveredDropCount = 0;
+
+	//Frames kept from the last run may have been made for another region
+	getROI(m_roiX, m_roiY, m_roiWidth, m_roiHeight);
+	releaseSlotFrames();
+
+	if (FAILED(Traits::subscribe(m_reader, &m_frameEvent))) {
+		imaqkit::adaptorError(this, "KinectAdapter:startCapture", "Unable to subscribe to %s frame arrived event.", Traits::name());
+		return false;
+	}
+
+	ResetEvent(m_stopEvent);
+	ResetEvent(m_captureFinishedEvent);
+
+	m_deliverThread = CreateThread(NULL, 0, deliverThread, this, 0, NULL);
+	if (m_deliverThread == NULL) {
+		imaqkit::adaptorError(this, "KinectAdapter:startCapture", "Unable to create frame delivery thread.");
+		Traits::unsubscribe(m_reader, m_frameEvent);
+		m_frameEvent = 0;
+		return false;
+	}
+
+	PostThreadMessage(m_aquireThreadID, WM_USER, 0, 0);
+
+	return true;
+}
+
+template <class Source>
+bool KinectAdapter<Source>::stopCapture() {
+	if (!isOpen()) {
+		return true;
+	}
+
+	//Unsubscribe only once the thread no longer waits on the frame event.
+	//The thread may already have finished if all frames were acquired.
+	SetEvent(m_stopEvent);
+	WaitForSingleObject(m_captureFinishedEvent, INFINITE);
+
+	//Frames already handed to the engine are complete once this returns
+	if (m_deliverThread) {
+		WaitForSingleObject(m_deliverThread, INFINITE);
+
+		CloseHandle(m_deliverThread);
+		m_deliverThread = NULL;
+	}
+
+	if (m_frameEvent) {
+		Traits::unsubscribe(m_reader, m_frameEvent);
+		m_frameEvent = 0;
+	}
+
+	return true;
+}
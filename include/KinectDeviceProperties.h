@@ -0,0 +1,71 @@
+#pragma once
+
+//Device-specific properties created in getDeviceAttributes.
+namespace kinectprops {
+	const char* const FRAME_QUEUE_DEPTH = "FrameQueueDepth";
+	const int FRAME_QUEUE_DEPTH_DEFAULT = 4;
+	const int FRAME_QUEUE_DEPTH_MAX = 64;
+
+	//Enum ids match FrameRing::DropPolicy
+	const char* const FRAME_DROP_POLICY = "FrameDropPolicy";
+	const char* const DROP_OLDEST_STR = "DropOldest";
+	const int DROP_OLDEST_ID = 1;
+	const char* const DROP_NEWEST_STR = "DropNewest";
+	const int DROP_NEWEST_ID = 2;
+	const char* const BLOCK_STR = "Block";
+	const int BLOCK_ID = 3;
+
+	//Read-only statistics of the sensor's frame buffer pool
+	const char* const BUFFER_POOL_HITS = "BufferPoolHits";
+	const char* const BUFFER_POOL_MISSES = "BufferPoolMisses";
+	const char* const BUFFER_POOL_BYTES_OUTSTANDING = "BufferPoolBytesOutstanding";
+
+	//Range mapped onto the MONO8 depth format, in millimetres
+	const char* const DEPTH_CLIP_MINIMUM = "DepthClipMinimum";
+	const int DEPTH_CLIP_MINIMUM_DEFAULT = 500;
+	const char* const DEPTH_CLIP_MAXIMUM = "DepthClipMaximum";
+	const int DEPTH_CLIP_MAXIMUM_DEFAULT = 4500;
+	const int DEPTH_CLIP_LIMIT = 8000;
+
+	//Temporal filter of the depth formats. The window is the span of the
+	//average, the frames of the median or the most frames a reading is
+	//held for.
+	const char* const TEMPORAL_FILTER = "TemporalFilter";
+	const char* const NONE_STR = "None";
+	const int NONE_ID = 1;
+	const char* const AVERAGE_STR = "Average";
+	const int AVERAGE_ID = 2;
+	const char* const MEDIAN_STR = "Median";
+	const int MEDIAN_ID = 3;
+	const char* const HOLD_INVALID_STR = "HoldInvalid";
+	const int HOLD_INVALID_ID = 4;
+	const char* const TEMPORAL_WINDOW = "TemporalWindow";
+	const int TEMPORAL_WINDOW_MINIMUM = 2;
+	const int TEMPORAL_WINDOW_MAXIMUM = 9;
+	const int TEMPORAL_WINDOW_DEFAULT = 5;
+
+	//YUV matrix of the RGB24 colour formats; ids match
+	//colourconversion::Matrix plus one
+	const char* const COLOUR_MATRIX = "ColourMatrix";
+	const char* const BT601_STR = "BT601";
+	const int BT601_ID = 1;
+	const char* const BT709_STR = "BT709";
+	const int BT709_ID = 2;
+
+	//Method of the RGB24_DEMOSAIC colour format
+	const char* const DEMOSAIC_METHOD = "DemosaicMethod";
+	const char* const BILINEAR_STR = "Bilinear";
+	const int BILINEAR_ID = 1;
+	const char* const EDGE_AWARE_STR = "EdgeAware";
+	const int EDGE_AWARE_ID = 2;
+
+	//Worker pool of the colour formats converted by the adapter. Zero
+	//threads means one per processor; a zero affinity mask leaves the
+	//threads unpinned.
+	const char* const WORKER_THREADS = "WorkerThreads";
+	const int WORKER_THREADS_MAX = 64;
+	//A double holds masks of processors 0 to 52 exactly, where an int
+	//property would stop at 31
+	const char* const WORKER_AFFINITY = "WorkerAffinity";
+	const double WORKER_AFFINITY_MAX = 9007199254740991.0;
+}
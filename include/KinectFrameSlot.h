@@ -0,0 +1,48 @@
+#pragma once
+
+#include <mwadaptorimaq.h>
+#include <windows.h>
+#include <Kinect.h>
+
+#include "BodyFrameData.h"
+
+//Numeric metadata captured alongside a frame and attached to the engine
+//frame on delivery. Names must outlive the frame (string literals); nothing
+//is copied or allocated.
+struct FrameMetadata {
+	static const int MAX_ITEMS = 16;
+
+	int count;
+	const char *names[MAX_ITEMS];
+	double values[MAX_ITEMS];
+
+	FrameMetadata() : count(0) {}
+
+	void clear() {
+		count = 0;
+	}
+
+	void add(const char *name, double value) {
+		if (count < MAX_ITEMS) {
+			names[count] = name;
+			values[count] = value;
+			count++;
+		}
+	}
+};
+
+//One preallocated entry of the capture to delivery frame ring. Adapters that
+//write in place keep an engine frame in the slot instead of a buffer; the
+//frame is reused until it is delivered. Body adapters also get fixed storage
+//for the frame's bodies.
+struct KinectFrameSlot {
+	BYTE *data;
+	imaqkit::IAdaptorFrame *frame;
+	double time;
+	double arrivalTime;
+	TIMESPAN relativeTime;
+	FrameMetadata metadata;
+	BodyFrameData *bodies;
+
+	KinectFrameSlot() : data(nullptr), frame(nullptr), time(0), arrivalTime(0), relativeTime(0), bodies(nullptr) {}
+};
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <map>
+#include <string>
+
+#include <mwadaptorimaq.h>
+#include <Kinect.h>
+
+#include "FrameBufferPool.h"
+#include "SensorClock.h"
+
+//Process-wide handle on an opened Kinect sensor, keyed by its unique id.
+//Every adapter streaming from the same physical sensor shares one session.
+//The sensor is opened by the first reference and is kept open once the last
+//reference is released, so re-opening a device does not renegotiate the USB
+//link; sessions are only closed when the adaptor is unloaded.
+//
+//The session also owns the frame buffer pool, the clock mapping and the
+//calibration tables of its sensor. Adapters must hand every buffer back
+//before releasing their reference.
+class KinectSensorSession
+{
+public:
+	static void initialize();
+	static void uninitialize();
+
+	static KinectSensorSession *acquire(IKinectSensor *sensor);
+	static void release(KinectSensorSession *session);
+
+	IKinectSensor *getSensor() const;
+	const std::wstring &getId() const;
+	int getReferenceCount() const;
+	FrameBufferPool &getBufferPool();
+	SensorClock &getClock();
+
+	//Per depth pixel X and Y of the camera space ray at 1 m depth. Fetched
+	//from the coordinate mapper on first use and kept with the session.
+	//Fails until the sensor has delivered its calibration.
+	HRESULT getDepthRayTable(const PointF **table, unsigned int *count);
+
+private:
+	KinectSensorSession(IKinectSensor *sensor, const std::wstring &id);
+	~KinectSensorSession();
+
+	bool open();
+	void close();
+
+	IKinectSensor *m_sensor;
+	std::wstring m_id;
+	int m_refCount;
+
+	FrameBufferPool m_bufferPool;
+	SensorClock m_clock;
+
+	PointF *m_depthRays;
+	UINT32 m_depthRayCount;
+
+	static imaqkit::ICriticalSection *s_lock;
+	static std::map<std::wstring, KinectSensorSession*> s_sessions;
+};
@@ -0,0 +1,231 @@
+#pragma once
+
+#include <Kinect.h>
+
+//Compile-time description of a Kinect frame source. KinectAdapter<Source>
+//uses these to name the reader, event and frame interfaces belonging to
+//each stream without any runtime dispatch.
+template <class Source>
+struct KinectSourceTraits;
+
+//Calls shared by every single-stream source.
+template <class Source, class ReaderType, class ArgsType, class ReferenceType, class FrameType>
+struct KinectFrameSourceTraits {
+	typedef ReaderType Reader;
+	typedef ArgsType ArrivedEventArgs;
+	typedef ReferenceType FrameReference;
+	typedef FrameType Frame;
+
+	static HRESULT getFrameDescription(Source *source, IFrameDescription **desc) {
+		return source->get_FrameDescription(desc);
+	}
+
+	static HRESULT openReader(Source *source, Reader **reader) {
+		return source->OpenReader(reader);
+	}
+
+	static HRESULT subscribe(Reader *reader, WAITABLE_HANDLE *frameEvent) {
+		return reader->SubscribeFrameArrived(frameEvent);
+	}
+
+	static HRESULT unsubscribe(Reader *reader, WAITABLE_HANDLE frameEvent) {
+		return reader->UnsubscribeFrameArrived(frameEvent);
+	}
+
+	static HRESULT getEventData(Reader *reader, WAITABLE_HANDLE frameEvent, ArrivedEventArgs **args) {
+		return reader->GetFrameArrivedEventData(frameEvent, args);
+	}
+
+	static HRESULT getRelativeTime(Frame *frame, TIMESPAN *time) {
+		return frame->get_RelativeTime(time);
+	}
+
+	//Exposes the SDK's own 16-bit frame buffer, valid until the frame is
+	//released. Lets callers copy only the part they need.
+	static HRESULT accessFrameData(Frame *frame, BYTE **buffer, unsigned int *size) {
+		UINT capacity;
+		UINT16 *data;
+		HRESULT hr = frame->AccessUnderlyingBuffer(&capacity, &data);
+		if (FAILED(hr)) {
+			return hr;
+		}
+
+		*buffer = reinterpret_cast<BYTE*>(data);
+		*size = capacity * sizeof(UINT16);
+		return S_OK;
+	}
+};
+
+template <>
+struct KinectSourceTraits<IColorFrameSource> :
+	public KinectFrameSourceTraits<IColorFrameSource, IColorFrameReader,
+		IColorFrameArrivedEventArgs, IColorFrameReference, IColorFrame>
+{
+	static const char *name() { return "Colour"; }
+
+	static HRESULT getSource(IKinectSensor *sensor, IColorFrameSource **source) {
+		return sensor->get_ColorFrameSource(source);
+	}
+
+	static HRESULT copyFrameData(IColorFrame *frame, BYTE *data, unsigned int size) {
+		return frame->CopyRawFrameDataToArray(size, data);
+	}
+
+	//The raw buffer holds the sensor's native format, YUY2
+	static HRESULT accessFrameData(IColorFrame *frame, BYTE **buffer, unsigned int *size) {
+		UINT capacity;
+		HRESULT hr = frame->AccessRawUnderlyingBuffer(&capacity, buffer);
+		*size = capacity;
+		return hr;
+	}
+};
+
+template <>
+struct KinectSourceTraits<IDepthFrameSource> :
+	public KinectFrameSourceTraits<IDepthFrameSource, IDepthFrameReader,
+		IDepthFrameArrivedEventArgs, IDepthFrameReference, IDepthFrame>
+{
+	static const char *name() { return "Depth"; }
+
+	static HRESULT getSource(IKinectSensor *sensor, IDepthFrameSource **source) {
+		return sensor->get_DepthFrameSource(source);
+	}
+
+	static HRESULT copyFrameData(IDepthFrame *frame, BYTE *data, unsigned int size) {
+		return frame->CopyFrameDataToArray(size / sizeof(UINT16), reinterpret_cast<UINT16*>(data));
+	}
+};
+
+template <>
+struct KinectSourceTraits<IInfraredFrameSource> :
+	public KinectFrameSourceTraits<IInfraredFrameSource, IInfraredFrameReader,
+		IInfraredFrameArrivedEventArgs, IInfraredFrameReference, IInfraredFrame>
+{
+	static const char *name() { return "Infrared"; }
+
+	static HRESULT getSource(IKinectSensor *sensor, IInfraredFrameSource **source) {
+		return sensor->get_InfraredFrameSource(source);
+	}
+
+	static HRESULT copyFrameData(IInfraredFrame *frame, BYTE *data, unsigned int size) {
+		return frame->CopyFrameDataToArray(size / sizeof(UINT16), reinterpret_cast<UINT16*>(data));
+	}
+};
+
+template <>
+struct KinectSourceTraits<ILongExposureInfraredFrameSource> :
+	public KinectFrameSourceTraits<ILongExposureInfraredFrameSource, ILongExposureInfraredFrameReader,
+		ILongExposureInfraredFrameArrivedEventArgs, ILongExposureInfraredFrameReference, ILongExposureInfraredFrame>
+{
+	static const char *name() { return "LongExposureInfrared"; }
+
+	static HRESULT getSource(IKinectSensor *sensor, ILongExposureInfraredFrameSource **source) {
+		return sensor->get_LongExposureInfraredFrameSource(source);
+	}
+
+	static HRESULT copyFrameData(ILongExposureInfraredFrame *frame, BYTE *data, unsigned int size) {
+		return frame->CopyFrameDataToArray(size / sizeof(UINT16), reinterpret_cast<UINT16*>(data));
+	}
+};
+
+template <>
+struct KinectSourceTraits<IBodyIndexFrameSource> :
+	public KinectFrameSourceTraits<IBodyIndexFrameSource, IBodyIndexFrameReader,
+		IBodyIndexFrameArrivedEventArgs, IBodyIndexFrameReference, IBodyIndexFrame>
+{
+	static const char *name() { return "BodyIndex"; }
+
+	static HRESULT getSource(IKinectSensor *sensor, IBodyIndexFrameSource **source) {
+		return sensor->get_BodyIndexFrameSource(source);
+	}
+
+	static HRESULT copyFrameData(IBodyIndexFrame *frame, BYTE *data, unsigned int size) {
+		return frame->CopyFrameDataToArray(size, data);
+	}
+
+	//Body indices are one byte per pixel
+	static HRESULT accessFrameData(IBodyIndexFrame *frame, BYTE **buffer, unsigned int *size) {
+		UINT capacity;
+		HRESULT hr = frame->AccessUnderlyingBuffer(&capacity, buffer);
+		*size = capacity;
+		return hr;
+	}
+};
+
+//Body frames carry no image; the adapter reads their bodies instead.
+template <>
+struct KinectSourceTraits<IBodyFrameSource> :
+	public KinectFrameSourceTraits<IBodyFrameSource, IBodyFrameReader,
+		IBodyFrameArrivedEventArgs, IBodyFrameReference, IBodyFrame>
+{
+	static const char *name() { return "Body"; }
+
+	static HRESULT getSource(IKinectSensor *sensor, IBodyFrameSource **source) {
+		return sensor->get_BodyFrameSource(source);
+	}
+
+	static HRESULT getFrameDescription(IBodyFrameSource *source, IFrameDescription **desc) {
+		return E_NOTIMPL;
+	}
+
+	static HRESULT copyFrameData(IBodyFrame *frame, BYTE *data, unsigned int size) {
+		return E_NOTIMPL;
+	}
+
+	static HRESULT accessFrameData(IBodyFrame *frame, BYTE **buffer, unsigned int *size) {
+		return E_NOTIMPL;
+	}
+};
+
+//The multi-source reader is opened on the sensor itself, so the sensor acts
+//as the source. Adapters choose the streams by overriding openReader.
+template <>
+struct KinectSourceTraits<IKinectSensor>
+{
+	typedef IMultiSourceFrameReader Reader;
+	typedef IMultiSourceFrameArrivedEventArgs ArrivedEventArgs;
+	typedef IMultiSourceFrameReference FrameReference;
+	typedef IMultiSourceFrame Frame;
+
+	static const char *name() { return "MultiSource"; }
+
+	static HRESULT getSource(IKinectSensor *sensor, IKinectSensor **source) {
+		sensor->AddRef();
+		*source = sensor;
+		return S_OK;
+	}
+
+	static HRESULT getFrameDescription(IKinectSensor *source, IFrameDescription **desc) {
+		return E_NOTIMPL;
+	}
+
+	static HRESULT openReader(IKinectSensor *source, IMultiSourceFrameReader **reader) {
+		return source->OpenMultiSourceFrameReader(FrameSourceTypes::FrameSourceTypes_Color
+			| FrameSourceTypes::FrameSourceTypes_Depth
+			| FrameSourceTypes::FrameSourceTypes_Infrared, reader);
+	}
+
+	static HRESULT subscribe(IMultiSourceFrameReader *reader, WAITABLE_HANDLE *frameEvent) {
+		return reader->SubscribeMultiSourceFrameArrived(frameEvent);
+	}
+
+	static HRESULT unsubscribe(IMultiSourceFrameReader *reader, WAITABLE_HANDLE frameEvent) {
+		return reader->UnsubscribeMultiSourceFrameArrived(frameEvent);
+	}
+
+	static HRESULT getEventData(IMultiSourceFrameReader *reader, WAITABLE_HANDLE frameEvent, IMultiSourceFrameArrivedEventArgs **args) {
+		return reader->GetMultiSourceFrameArrivedEventData(frameEvent, args);
+	}
+
+	static HRESULT copyFrameData(IMultiSourceFrame *frame, BYTE *data, unsigned int size) {
+		return E_NOTIMPL;
+	}
+
+	static HRESULT accessFrameData(IMultiSourceFrame *frame, BYTE **buffer, unsigned int *size) {
+		return E_NOTIMPL;
+	}
+
+	static HRESULT getRelativeTime(IMultiSourceFrame *frame, TIMESPAN *time) {
+		return E_NOTIMPL;
+	}
+};
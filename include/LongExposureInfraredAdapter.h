@@ -1,13 +1,13 @@
 #pragma once
-#pragma once
 
 #include <mwadaptorimaq.h>
 #include <Kinect.h>
 
+#include "KinectAdapter.h"
 #include "KinectDeviceInfo.h"
 
 class LongExposureInfraredAdapter :
-	public imaqkit::IAdaptor
+	public KinectAdapter<ILongExposureInfraredFrameSource>
 {
 public:
 	LongExposureInfraredAdapter(imaqkit::IEngine* engine,
@@ -17,11 +17,6 @@ public:
 
 	//Driver information
 	virtual const char* getDriverDescription() const override;
-	virtual const char* getDriverVersion() const override;
-
-	//Device control functions
-	virtual bool openDevice() override;
-	virtual bool closeDevice() override;
 
 	//Device frame information
 	virtual imaqkit::frametypes::FRAMETYPE getFrameType() const override;
@@ -29,33 +24,6 @@ public:
 	virtual int getMaxWidth() const override;
 	virtual int getNumberOfBands() const override;
 
-	virtual WAITABLE_HANDLE getFrameEvent();
-	IKinectSensor *getSensor() const;
-	ILongExposureInfraredFrameSource *getSource() const;
-	ILongExposureInfraredFrameReader *getReader() const;
-	unsigned int getFrameSize() const;
-
-	bool aquireFrame() const;
-	void notifyCaptureFinished();
-
-	//Device capture control
-	virtual bool startCapture() override;
-	virtual bool stopCapture() override;
-
-private:
-	IKinectSensor *m_sensor;
-	ILongExposureInfraredFrameSource *m_source;
-	ILongExposureInfraredFrameReader *m_reader; 
-
-	static DWORD WINAPI aquireThread(void* param);
-	HANDLE m_aquireThread;
-	DWORD m_aquireThreadID;
-
-	WAITABLE_HANDLE m_frameEvent;
-
-	unsigned int m_frameSize;
-
-	bool m_aquireFrame;
-	bool m_captureFinished;
+protected:
+	virtual bool writesFrameInPlace() const override;
 };
-
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <vector>
+
+#include <windows.h>
+
+//Persistent worker threads that split per-frame image work into bands of
+//rows. The calling thread works on the first band itself, so a pool of one
+//thread runs everything inline.
+class RowBandPool
+{
+public:
+	//Processes rows [first, last); bands never overlap.
+	class Task
+	{
+	public:
+		virtual ~Task() {}
+		virtual void run(int first, int last) = 0;
+	};
+
+	//A thread count of zero uses one thread per processor of the affinity
+	//mask, or per logical processor without one. A non-zero affinity mask
+	//pins each thread to one of its processors in turn, the calling thread
+	//to the first while it works on its band in run.
+	RowBandPool(int threadCount = 0, DWORD_PTR affinityMask = 0);
+	~RowBandPool();
+
+	//Threads sharing the work, the calling one included. Lower than asked
+	//for if workers failed to start.
+	int getThreadCount() const;
+	DWORD_PTR getAffinityMask() const;
+
+	//Returns once every band of rows has been processed.
+	void run(Task &task, int rows);
+
+private:
+	struct Worker {
+		RowBandPool *pool;
+		int index;
+		HANDLE thread;
+		HANDLE startEvent;
+		HANDLE doneEvent;
+	};
+
+	static DWORD WINAPI workerThread(void* param);
+	void runBand(int index);
+
+	std::vector<Worker> m_workers;
+	std::vector<HANDLE> m_doneEvents;
+	int m_threadCount;
+	DWORD_PTR m_affinityMask;
+	//Processor of the calling thread's band, 0 if it is not pinned
+	DWORD_PTR m_callerMask;
+
+	//Set before the start events are signalled
+	Task *m_task;
+	int m_rows;
+	bool m_exit;
+
+	RowBandPool(const RowBandPool&);
+	RowBandPool &operator=(const RowBandPool&);
+};
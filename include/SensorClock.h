@@ -0,0 +1,87 @@
+#pragma once
+
+#include <windows.h>
+#include <Kinect.h>
+
+//Maps the sensor's RelativeTime onto the engine clock. Every stream of a
+//sensor shares one mapping so equal sensor times map to equal frame times.
+//
+//Frame arrival times on the host include scheduling jitter and transfer
+//latency. An exponentially weighted least squares fit of host time against
+//sensor time averages the jitter out and follows the slow drift between the
+//two clocks; frames are then stamped from the fitted line.
+//
+//Each stream arrives with its own latency, and streams update the clock in
+//no particular order. The first stream to update is the reference the line
+//is fitted to; the others keep a running estimate of their latency relative
+//to it, which is taken off their arrival times before they join the fit.
+class SensorClock
+{
+public:
+	//Weight kept by past samples per update, about 30 s of history at 30 fps
+	static const double DEFAULT_FORGETTING;
+
+	//Drift between two crystal clocks stays far below this
+	static const double MAX_DRIFT;
+
+	//Distinct streams tracked; later ones join the fit without a latency
+	//correction
+	static const int MAX_STREAMS = 8;
+
+	SensorClock(double forgetting = DEFAULT_FORGETTING);
+	~SensorClock();
+
+	void reset();
+
+	//Adds the host time a frame of stream arrived at and returns its mapped
+	//time. stream is any value telling the streams apart.
+	double update(int stream, TIMESPAN sensorTime, double hostTime);
+	double map(TIMESPAN sensorTime) const;
+
+	//Fitted rate of the host clock relative to the sensor clock, minus one.
+	double getDrift() const;
+	//RMS distance of the host arrival times from the fit, in seconds.
+	double getJitter() const;
+	//Latency of stream relative to the reference stream, in seconds.
+	double getLatency(int stream) const;
+	unsigned int getSampleCount() const;
+
+private:
+	struct Stream {
+		int key;
+		double latency;
+		unsigned int samples;
+	};
+
+	void clear();
+	Stream *findStream(int key, bool add);
+	double toSeconds(TIMESPAN sensorTime) const;
+	double mapLocked(double x) const;
+
+	//Taken on the capture threads for every frame, so a plain critical
+	//section rather than the kit's, whose guards are allocated
+	mutable CRITICAL_SECTION m_lock;
+
+	double m_forgetting;
+
+	TIMESPAN m_sensorOrigin;
+	double m_hostOrigin;
+
+	Stream m_streams[MAX_STREAMS];
+	int m_streamCount;
+
+	//Weighted sums of the samples relative to the origins
+	double m_weight;
+	double m_sumX;
+	double m_sumY;
+	double m_sumXX;
+	double m_sumXY;
+
+	double m_slope;
+	double m_intercept;
+	double m_residual;
+	unsigned int m_samples;
+
+	SensorClock(const SensorClock&);
+	SensorClock &operator=(const SensorClock&);
+};
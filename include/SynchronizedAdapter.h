@@ -0,0 +1,75 @@
+#pragma once
+
+#include <vector>
+
+#include <mwadaptorimaq.h>
+#include <Kinect.h>
+
+#include "FramePairing.h"
+#include "KinectAdapter.h"
+#include "KinectDeviceInfo.h"
+
+//Acquires colour, depth and infrared through one multi-source reader and
+//only delivers tuples whose sensor timestamps match. Depth and infrared are
+//delivered together as one image, depth rows above infrared rows; the
+//matched sensor times are attached as frame metadata. The colour frame only
+//validates the tuple, its pixels are delivered by the registered format.
+//
+//The registered format instead delivers the matched colour frame resampled
+//onto the depth pixels, as RGB24 at depth resolution.
+//
+//The HDR formats read the short and long exposure infrared streams instead
+//and fuse each matched pair into one high dynamic range image.
+class SynchronizedAdapter :
+	public KinectAdapter<IKinectSensor>
+{
+public:
+	SynchronizedAdapter(imaqkit::IEngine* engine,
+		const KinectDeviceInfo *deviceInfo,
+		const char* formatName);
+	~SynchronizedAdapter();
+
+	//Driver information
+	virtual const char* getDriverDescription() const override;
+
+	//Device frame information
+	virtual imaqkit::frametypes::FRAMETYPE getFrameType() const override;
+	virtual int getMaxHeight() const override;
+	virtual int getMaxWidth() const override;
+	virtual int getNumberOfBands() const override;
+
+	virtual bool startCapture() override;
+
+protected:
+	virtual unsigned int queryFrameSize() override;
+	virtual HRESULT openReader(IKinectSensor *source, IMultiSourceFrameReader **reader) override;
+	virtual HRESULT copyFrameData(IMultiSourceFrame *frame, BYTE *data, unsigned int size) override;
+	virtual HRESULT getRelativeTime(IMultiSourceFrame *frame, TIMESPAN *time) override;
+	virtual void getFrameMetadata(IMultiSourceFrame *frame, FrameMetadata &metadata) override;
+	virtual bool writesFrameInPlace() const override;
+
+private:
+	enum Stream { DEPTH_STREAM, INFRARED_STREAM, COLOUR_STREAM, STREAM_COUNT };
+	enum ExposureStream { SHORT_EXPOSURE, LONG_EXPOSURE, EXPOSURE_COUNT };
+	enum SynchronizedOutput { STACKED_OUTPUT, REGISTERED_OUTPUT, HDR_FLOAT_OUTPUT, HDR_MONO16_OUTPUT };
+
+	HRESULT copyRegisteredFrame(IMultiSourceFrame *frame, BYTE *data);
+	HRESULT copyHdrFrame(IMultiSourceFrame *frame, BYTE *data);
+	bool isHdr() const;
+
+	FramePairing m_pairing;
+	int m_slots[STREAM_COUNT];
+
+	FramePairing m_exposurePairing;
+	int m_exposureSlots[EXPOSURE_COUNT];
+	//Long over short exposure brightness, estimated from every pair
+	float m_exposureRatio;
+
+	SynchronizedOutput m_output;
+	ICoordinateMapper *m_mapper;
+	//Colour position of every depth pixel, and the RelativeTime of the depth
+	//frame it was mapped for
+	std::vector<ColorSpacePoint> m_colourPoints;
+	TIMESPAN m_mappedDepthTime;
+	bool m_hasMapping;
+};
@@ -0,0 +1,80 @@
+#include "../include/BodyAdapter.h"
+
+BodyAdapter::BodyAdapter(imaqkit::IEngine* engine,
+	const KinectDeviceInfo *deviceInfo,
+	const char* formatName) 
+	:KinectAdapter(engine, deviceInfo),
+	m_trackedCount(0) {
+
+	for (int i = 0; i < BodyFrameData::BODIES; i++) {
+		m_bodies[i] = nullptr;
+	}
+}
+
+BodyAdapter::~BodyAdapter() {
+	stopAndJoin();
+
+	for (int i = 0; i < BodyFrameData::BODIES; i++) {
+		if (m_bodies[i] != nullptr) {
+			m_bodies[i]->Release();
+		}
+	}
+}
+
+const char* BodyAdapter::getDriverDescription() const {
+	return "KinectV2Body_Driver";
+}
+
+unsigned int BodyAdapter::queryFrameSize() {
+	return BodyFrameData::BODIES;
+}
+
+HRESULT BodyAdapter::copyFrameData(IBodyFrame *frame, BYTE *data, unsigned int size) {
+	HRESULT hr = frame->GetAndRefreshBodyData(BodyFrameData::BODIES, m_bodies);
+	if (FAILED(hr)) {
+		return hr;
+	}
+
+	int originX, originY, width, height;
+	getRegion(originX, originY, width, height);
+
+	m_trackedCount = 0;
+	for (int i = 0; i < BodyFrameData::BODIES; i++) {
+		BOOLEAN tracked = false;
+		if (m_bodies[i] != nullptr) {
+			m_bodies[i]->get_IsTracked(&tracked);
+		}
+		if (tracked) {
+			m_trackedCount++;
+		}
+
+		if (i >= originX && i < originX + width) {
+			data[i - originX] = tracked ? 255 : 0;
+		}
+	}
+
+	return S_OK;
+}
+
+bool BodyAdapter::writesFrameInPlace() const {
+	return true;
+}
+
+void BodyAdapter::getFrameMetadata(IBodyFrame *frame, FrameMetadata &metadata) {
+	metadata.add("TrackedBodies", m_trackedCount);
+}
+
+bool BodyAdapter::deliversBodies() const {
+	return true;
+}
+
+void BodyAdapter::getFrameBodies(IBodyFrame *frame, BodyFrameData &bodies) {
+	bodies.read(m_bodies, BodyFrameData::BODIES);
+}
+
+imaqkit::frametypes::FRAMETYPE BodyAdapter::getFrameType() const { 
+	return imaqkit::frametypes::MONO8;
+}
+int BodyAdapter::getMaxHeight() const { return 1; }
+int BodyAdapter::getMaxWidth() const { return BodyFrameData::BODIES; }
+int BodyAdapter::getNumberOfBands() const { return 1; }
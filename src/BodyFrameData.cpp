@@ -0,0 +1,92 @@
+#include "../include/BodyFrameData.h"
+
+#include <cstring>
+
+BodyFrameData::BodyFrameData() {
+	for (int b = 0; b < BODIES; b++) {
+		m_idRows[b] = trackingIds[b];
+		m_handRows[b] = handStates[b];
+		m_stateRows[b] = jointStates[b];
+
+		for (int j = 0; j < JOINTS; j++) {
+			m_positionRows[b][j] = positions[b][j];
+			m_orientationRows[b][j] = orientations[b][j];
+		}
+		m_positionBodies[b] = m_positionRows[b];
+		m_orientationBodies[b] = m_orientationRows[b];
+	}
+
+	clear();
+}
+
+void BodyFrameData::clear() {
+	memset(tracked, 0, sizeof(tracked));
+	memset(trackingIds, 0, sizeof(trackingIds));
+	memset(handStates, 0, sizeof(handStates));
+	memset(positions, 0, sizeof(positions));
+	memset(orientations, 0, sizeof(orientations));
+	memset(jointStates, 0, sizeof(jointStates));
+}
+
+void BodyFrameData::read(IBody *const *bodies, int count) {
+	clear();
+
+	Joint joints[JOINTS];
+	JointOrientation jointOrientations[JOINTS];
+
+	for (int b = 0; b < count && b < BODIES; b++) {
+		BOOLEAN isTracked = false;
+		if (bodies[b] == nullptr || FAILED(bodies[b]->get_IsTracked(&isTracked)) || !isTracked) {
+			continue;
+		}
+
+		IBody *body = bodies[b];
+		tracked[b] = 1;
+
+		UINT64 id;
+		if (SUCCEEDED(body->get_TrackingId(&id))) {
+			trackingIds[b][0] = static_cast<double>(id >> 32);
+			trackingIds[b][1] = static_cast<double>(id & 0xFFFFFFFF);
+		}
+
+		HandState left, right;
+		if (SUCCEEDED(body->get_HandLeftState(&left))) {
+			handStates[b][0] = left;
+		}
+		if (SUCCEEDED(body->get_HandRightState(&right))) {
+			handStates[b][1] = right;
+		}
+
+		//Joints come back indexed by JointType
+		if (SUCCEEDED(body->GetJoints(JOINTS, joints))) {
+			for (int j = 0; j < JOINTS; j++) {
+				positions[b][j][0] = joints[j].Position.X;
+				positions[b][j][1] = joints[j].Position.Y;
+				positions[b][j][2] = joints[j].Position.Z;
+				jointStates[b][j] = joints[j].TrackingState;
+			}
+		}
+
+		if (SUCCEEDED(body->GetJointOrientations(JOINTS, jointOrientations))) {
+			for (int j = 0; j < JOINTS; j++) {
+				orientations[b][j][0] = jointOrientations[j].Orientation.x;
+				orientations[b][j][1] = jointOrientations[j].Orientation.y;
+				orientations[b][j][2] = jointOrientations[j].Orientation.z;
+				orientations[b][j][3] = jointOrientations[j].Orientation.w;
+			}
+		}
+	}
+}
+
+void BodyFrameData::attach(imaqkit::IAdaptorFrame *frame) {
+	frame->addMetaItem("BodyTracked", tracked, BODIES);
+	frame->addMetaItem("BodyTrackingId", m_idRows, BODIES, 2);
+	frame->addMetaItem("HandStates", m_handRows, BODIES, 2);
+	frame->addMetaItem("JointPositions", m_positionBodies, BODIES, JOINTS, 3);
+	frame->addMetaItem("JointOrientations", m_orientationBodies, BODIES, JOINTS, 4);
+	frame->addMetaItem("JointTrackingStates", m_stateRows, BODIES, JOINTS);
+}
+
+bool BodyFrameData::isTracked(int body) const {
+	return tracked[body] != 0;
+}
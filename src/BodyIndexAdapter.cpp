@@ -0,0 +1,175 @@
+#include "../include/BodyIndexAdapter.h"
+
+#include "../include/DepthConversion.h"
+
+static const int depthWidth = 512;
+static const int depthHeight = 424;
+static const int depthPixels = depthWidth * depthHeight;
+
+//Sensor time of a history entry that holds no frame
+static const TIMESPAN noDepthTime = -1;
+
+BodyIndexAdapter::BodyIndexAdapter(imaqkit::IEngine* engine,
+	const KinectDeviceInfo *deviceInfo,
+	const char* formatName) 
+	:KinectAdapter(engine, deviceInfo),
+	m_masked(strcmp(formatName, "MONO12_MASKED_512x424") == 0),
+	m_depthReader(nullptr),
+	m_latestDepth(0) {
+
+	for (int i = 0; i < DEPTH_HISTORY; i++) {
+		if (m_masked) {
+			m_depth[i].resize(depthPixels);
+		}
+		m_depthTimes[i] = noDepthTime;
+	}
+}
+
+BodyIndexAdapter::~BodyIndexAdapter() {
+	stopAndJoin();
+
+	if (m_depthReader != nullptr) {
+		m_depthReader->Release();
+	}
+}
+
+const char* BodyIndexAdapter::getDriverDescription() const {
+	return "KinectV2BodyIndex_Driver";
+}
+
+bool BodyIndexAdapter::startCapture() {
+	if (m_masked) {
+		//A reader left open by an earlier start is reused
+		if (m_depthReader == nullptr) {
+			IDepthFrameSource *depthSource;
+			if (FAILED(getSensor()->get_DepthFrameSource(&depthSource))) {
+				imaqkit::adaptorError(this, "BodyIndexAdapter:startCapture", "Unable to get Depth source from kinect device.");
+				return false;
+			}
+
+			HRESULT hr = depthSource->OpenReader(&m_depthReader);
+			depthSource->Release();
+			if (FAILED(hr)) {
+				imaqkit::adaptorError(this, "BodyIndexAdapter:startCapture", "Unable to get frame reader from Depth source.");
+				m_depthReader = nullptr;
+				return false;
+			}
+		}
+
+		for (int i = 0; i < DEPTH_HISTORY; i++) {
+			m_depthTimes[i] = noDepthTime;
+		}
+	}
+
+	//stopCapture is not called after a failed start
+	if (!KinectAdapter::startCapture()) {
+		if (m_depthReader != nullptr) {
+			m_depthReader->Release();
+			m_depthReader = nullptr;
+		}
+		return false;
+	}
+
+	return true;
+}
+
+bool BodyIndexAdapter::stopCapture() {
+	bool stopped = KinectAdapter::stopCapture();
+
+	if (m_depthReader != nullptr) {
+		m_depthReader->Release();
+		m_depthReader = nullptr;
+	}
+
+	return stopped;
+}
+
+unsigned int BodyIndexAdapter::queryFrameSize() {
+	if (m_masked) {
+		return depthPixels * sizeof(UINT16);
+	}
+	return KinectAdapter::queryFrameSize();
+}
+
+HRESULT BodyIndexAdapter::copyFrameData(IBodyIndexFrame *frame, BYTE *data, unsigned int size) {
+	if (m_masked) {
+		return copyMaskedDepth(frame, data);
+	}
+	return KinectAdapter::copyFrameData(frame, data, size);
+}
+
+//A body index frame whose depth frame was never seen is dropped
+HRESULT BodyIndexAdapter::copyMaskedDepth(IBodyIndexFrame *frame, BYTE *data) {
+	TIMESPAN time;
+	HRESULT hr = frame->get_RelativeTime(&time);
+	if (FAILED(hr)) {
+		return hr;
+	}
+
+	pollDepth();
+
+	const UINT16 *depth = findDepth(time);
+	if (depth == nullptr) {
+		return E_PENDING;
+	}
+
+	UINT capacity;
+	BYTE *bodyIndex;
+	hr = frame->AccessUnderlyingBuffer(&capacity, &bodyIndex);
+	if (FAILED(hr)) {
+		return hr;
+	}
+	if (capacity < depthPixels) {
+		return E_UNEXPECTED;
+	}
+
+	int originX, originY, width, height;
+	getRegion(originX, originY, width, height);
+
+	UINT16 *masked = reinterpret_cast<UINT16*>(data);
+	for (int y = 0; y < height; y++) {
+		int offset = (originY + y) * depthWidth + originX;
+		depthconversion::applyBodyMask(depth + offset, bodyIndex + offset, width, masked + y * width);
+	}
+
+	return S_OK;
+}
+
+void BodyIndexAdapter::pollDepth() {
+	IDepthFrame *depthFrame;
+	if (FAILED(m_depthReader->AcquireLatestFrame(&depthFrame))) {
+		return;
+	}
+
+	TIMESPAN time;
+	if (SUCCEEDED(depthFrame->get_RelativeTime(&time)) && time != m_depthTimes[m_latestDepth]) {
+		int next = (m_latestDepth + 1) % DEPTH_HISTORY;
+
+		if (SUCCEEDED(depthFrame->CopyFrameDataToArray(depthPixels, &m_depth[next][0]))) {
+			m_depthTimes[next] = time;
+			m_latestDepth = next;
+		}
+	}
+
+	depthFrame->Release();
+}
+
+const UINT16 *BodyIndexAdapter::findDepth(TIMESPAN time) const {
+	for (int i = 0; i < DEPTH_HISTORY; i++) {
+		if (m_depthTimes[i] == time) {
+			return &m_depth[i][0];
+		}
+	}
+	return nullptr;
+}
+
+bool BodyIndexAdapter::writesFrameInPlace() const {
+	return true;
+}
+
+imaqkit::frametypes::FRAMETYPE BodyIndexAdapter::getFrameType() const { 
+	return m_masked ? imaqkit::frametypes::MONO12 : imaqkit::frametypes::MONO8;
+}
+int BodyIndexAdapter::getMaxHeight() const { return depthHeight; }
+int BodyIndexAdapter::getMaxWidth() const { return depthWidth; }
+int BodyIndexAdapter::getNumberOfBands() const { return 1; }
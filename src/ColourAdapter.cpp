@@ -1,12 +1,110 @@
 #include "../include/ColourAdapter.h"
 
+#include "../include/DepthConversion.h"
+
+static const int colourWidth = 1920;
+static const int colourHeight = 1080;
+static const int depthWidth = 512;
+static const int depthHeight = 424;
+static const int depthPixels = depthWidth * depthHeight;
+
+//Widest run of unreached colour pixels closed after splatting the depth
+static const int maxDepthGap = 4;
+
+namespace {
+	//Renders one band of rows of the depth output
+	class DepthSplatTask :
+		public RowBandPool::Task
+	{
+	public:
+		DepthSplatTask(const depthconversion::ColourMapping &mapping,
+			int originX, int originY, int width, UINT16 *colourDepth)
+			:m_mapping(mapping),
+			m_originX(originX),
+			m_originY(originY),
+			m_width(width),
+			m_colourDepth(colourDepth) {}
+
+		virtual void run(int first, int last) override {
+			depthconversion::splatToColour(m_mapping, m_originX, m_originY, m_width,
+				first, last, m_colourDepth);
+
+			for (int y = first; y < last; y++) {
+				depthconversion::fillRowGaps(m_colourDepth + y * m_width, m_width, maxDepthGap);
+			}
+		}
+
+	private:
+		const depthconversion::ColourMapping &m_mapping;
+		int m_originX;
+		int m_originY;
+		int m_width;
+		UINT16 *m_colourDepth;
+	};
+
+	//Interpolates one band of the green plane, offset by the first row
+	//the region needs
+	class GreenTask :
+		public RowBandPool::Task
+	{
+	public:
+		GreenTask(const BYTE *mosaic, int top, BYTE *green)
+			:m_mosaic(mosaic),
+			m_top(top),
+			m_green(green) {}
+
+		virtual void run(int first, int last) override {
+			colourconversion::interpolateGreen(m_mosaic, colourWidth, colourHeight,
+				m_top + first, m_top + last, m_green);
+		}
+
+	private:
+		const BYTE *m_mosaic;
+		int m_top;
+		BYTE *m_green;
+	};
+}
+
+class ColourAdapter::CopyRowsTask :
+	public RowBandPool::Task
+{
+public:
+	CopyRowsTask(const ColourAdapter *adapter, const BYTE *yuy2, BYTE *data)
+		:m_adapter(adapter),
+		m_yuy2(yuy2),
+		m_data(data) {}
+
+	virtual void run(int first, int last) override {
+		m_adapter->copyRows(m_yuy2, first, last, m_data);
+	}
+
+private:
+	const ColourAdapter *m_adapter;
+	const BYTE *m_yuy2;
+	BYTE *m_data;
+};
+
 ColourAdapter::ColourAdapter(imaqkit::IEngine* engine,
 	const KinectDeviceInfo *deviceInfo,
 	const char* formatName) 
-		:imaqkit::IAdaptor(engine),
-		 m_frameEvent() {
+		:KinectAdapter(engine, deviceInfo),
+		 m_format(ColorImageFormat::ColorImageFormat_Rgba),
+		 m_rgb24(false),
+		 m_scale(1),
+		 m_planar(false),
+		 m_matrix(colourconversion::BT601),
+		 m_demosaic(false),
+		 m_edgeAware(false),
+		 m_depthOutput(false),
+		 m_depthReader(nullptr),
+		 m_mapper(nullptr),
+		 m_workers(nullptr),
+		 m_workerThreads(0),
+		 m_depthTime(0),
+		 m_hasDepth(false),
+		 m_regionX(0),
+		 m_regionY(0) {
 
-	m_sensor = deviceInfo->getDevice();
 	if (strcmp(formatName, "RGB32_1920x1080") == 0) {
 		m_format = ColorImageFormat::ColorImageFormat_Rgba;
 	}
@@ -22,204 +120,369 @@ ColourAdapter::ColourAdapter(imaqkit::IEngine* engine,
 	else if (strcmp(formatName, "YUV_YUY2_1920x1080") == 0) {
 		m_format = ColorImageFormat::ColorImageFormat_Yuy2;
 	}
-}
-
-ColourAdapter::~ColourAdapter() {}
+	//RGB24 formats are converted by the adapter from the raw YUY2
+	else if (strcmp(formatName, "RGB24_1920x1080") == 0) {
+		m_format = ColorImageFormat::ColorImageFormat_Yuy2;
+		m_rgb24 = true;
+	}
+	else if (strcmp(formatName, "RGB24_960x540") == 0) {
+		m_format = ColorImageFormat::ColorImageFormat_Yuy2;
+		m_rgb24 = true;
+		m_scale = 2;
+	}
+	else if (strcmp(formatName, "RGB24_480x270") == 0) {
+		m_format = ColorImageFormat::ColorImageFormat_Yuy2;
+		m_rgb24 = true;
+		m_scale = 4;
+	}
+	else if (strcmp(formatName, "RGB24_PLANAR_1920x1080") == 0) {
+		m_format = ColorImageFormat::ColorImageFormat_Yuy2;
+		m_rgb24 = true;
+		m_planar = true;
+	}
+	else if (strcmp(formatName, "RGB24_PLANAR_960x540") == 0) {
+		m_format = ColorImageFormat::ColorImageFormat_Yuy2;
+		m_rgb24 = true;
+		m_planar = true;
+		m_scale = 2;
+	}
+	else if (strcmp(formatName, "RGB24_PLANAR_480x270") == 0) {
+		m_format = ColorImageFormat::ColorImageFormat_Yuy2;
+		m_rgb24 = true;
+		m_planar = true;
+		m_scale = 4;
+	}
+	else if (strcmp(formatName, "RGB24_DEMOSAIC_1920x1080") == 0) {
+		m_format = ColorImageFormat::ColorImageFormat_Bayer;
+		m_rgb24 = true;
+		m_demosaic = true;
+	}
+	else if (strcmp(formatName, "MONO16_DEPTH_1920x1080") == 0) {
+		m_depthOutput = true;
+	}
 
-const char* ColourAdapter::getDriverDescription() const {
-	return "KinectV2Colour_Driver";
-}
-const char* ColourAdapter::getDriverVersion() const {
-	return "0.0.1";
-}
+	if (m_demosaic) {
+		m_mosaic.resize(colourWidth * colourHeight);
+		m_green.resize(colourWidth * colourHeight);
+	}
+	if (m_depthOutput) {
+		m_depth.resize(depthPixels);
+		m_colourPoints.resize(depthPixels);
+		m_rowTop.resize(depthHeight);
+		m_rowBottom.resize(depthHeight);
+	}
 
-WAITABLE_HANDLE ColourAdapter::getFrameEvent() {
-	return m_frameEvent;
+	m_regionWidth = getMaxWidth();
+	m_regionHeight = getMaxHeight();
 }
 
-IKinectSensor *ColourAdapter::getSensor() const {
-	return m_sensor;
-}
+ColourAdapter::~ColourAdapter() {
+	stopAndJoin();
 
-IColorFrameSource *ColourAdapter::getSource() const {
-	return m_source;
+	if (m_depthReader != nullptr) {
+		m_depthReader->Release();
+	}
+	if (m_mapper != nullptr) {
+		m_mapper->Release();
+	}
+	delete m_workers;
 }
 
-IColorFrameReader *ColourAdapter::getReader() const {
-	return m_reader;
+const char* ColourAdapter::getDriverDescription() const {
+	return "KinectV2Colour_Driver";
 }
 
 ColorImageFormat ColourAdapter::getFormat() const {
 	return m_format;
 }
 
-unsigned int ColourAdapter::getFrameSize() const {
-	return m_frameSize;
+void ColourAdapter::getROI(int &originX, int &originY, int &width, int &height) const {
+	originX = m_regionX;
+	originY = m_regionY;
+	width = m_regionWidth;
+	height = m_regionHeight;
 }
 
-bool ColourAdapter::aquireFrame() const {
-	return m_aquireFrame;
-}
+void ColourAdapter::setROI(const int originX, const int originY, const int width, const int height) {
+	bool yuy2 = m_format == ColorImageFormat::ColorImageFormat_Yuy2 && !m_rgb24 && !m_depthOutput;
 
-void ColourAdapter::notifyCaptureFinished() {
-	m_captureFinished = true;
+	m_regionX = yuy2 ? originX - originX % 2 : originX;
+	m_regionY = originY;
+	m_regionWidth = width;
+	m_regionHeight = height;
+	KinectAdapter::setROI(m_regionX, m_regionY, m_regionWidth, m_regionHeight);
 }
 
-bool ColourAdapter::openDevice() {
+bool ColourAdapter::startCapture() {
+	imaqkit::IPropContainer *props = getEngine()->getAdaptorPropContainer();
+
+	m_matrix = props->getPropValueAsInt(kinectprops::COLOUR_MATRIX) == kinectprops::BT709_ID
+		? colourconversion::BT709 : colourconversion::BT601;
+	m_edgeAware = props->getPropValueAsInt(kinectprops::DEMOSAIC_METHOD) == kinectprops::EDGE_AWARE_ID;
 
-	if (isOpen()) {
-		return true;
+	if (writesFrameInPlace()) {
+		int threads = props->getPropValueAsInt(kinectprops::WORKER_THREADS);
+		DWORD_PTR affinity = static_cast<DWORD_PTR>(
+			static_cast<unsigned long long>(props->getPropValueAsDouble(kinectprops::WORKER_AFFINITY)));
+
+		if (m_workers == nullptr || threads != m_workerThreads || affinity != m_workers->getAffinityMask()) {
+			delete m_workers;
+			m_workers = new RowBandPool(threads, affinity);
+			m_workerThreads = threads;
+		}
 	}
 
-	BOOLEAN open;
+	if (m_depthOutput) {
+		if (m_mapper == nullptr && FAILED(getSensor()->get_CoordinateMapper(&m_mapper))) {
+			imaqkit::adaptorError(this, "ColourAdapter:startCapture", "Unable to get coordinate mapper from kinect device.");
+			m_mapper = nullptr;
+			return false;
+		}
+
+		//A reader left open by an earlier start is reused
+		if (m_depthReader == nullptr) {
+			IDepthFrameSource *depthSource;
+			if (FAILED(getSensor()->get_DepthFrameSource(&depthSource))) {
+				imaqkit::adaptorError(this, "ColourAdapter:startCapture", "Unable to get Depth source from kinect device.");
+				return false;
+			}
+
+			HRESULT hr = depthSource->OpenReader(&m_depthReader);
+			depthSource->Release();
+			if (FAILED(hr)) {
+				imaqkit::adaptorError(this, "ColourAdapter:startCapture", "Unable to get frame reader from Depth source.");
+				m_depthReader = nullptr;
+				return false;
+			}
+		}
 
-	if (FAILED(m_sensor->get_IsOpen(&open))) {
-		imaqkit::adaptorError(this, "ColourAdapter:openDevice", "Unable to determine kinect device status.");
+		m_hasDepth = false;
 	}
-	
-	if (!open && FAILED(m_sensor->Open())) {
-		imaqkit::adaptorError(this, "ColourAdapter:openDevice", "Unable to open kinect device.");
-		closeDevice();
+
+	//stopCapture is not called after a failed start
+	if (!KinectAdapter::startCapture()) {
+		if (m_depthReader != nullptr) {
+			m_depthReader->Release();
+			m_depthReader = nullptr;
+		}
 		return false;
 	}
 
-	if (FAILED(m_sensor->get_ColorFrameSource(&m_source))) {
-		imaqkit::adaptorError(this, "ColourAdapter:openDevice", "Unable to get color frame source from kinect device.");
-		closeDevice();
-		return false;
+	return true;
+}
+
+bool ColourAdapter::stopCapture() {
+	bool stopped = KinectAdapter::stopCapture();
+
+	//Closing the reader lets the depth stream stop between captures
+	if (m_depthReader != nullptr) {
+		m_depthReader->Release();
+		m_depthReader = nullptr;
+	}
+
+	return stopped;
+}
+
+unsigned int ColourAdapter::queryFrameSize() {
+	if (m_depthOutput) {
+		return getMaxWidth() * getMaxHeight() * sizeof(UINT16);
+	}
+	if (m_rgb24) {
+		return getMaxWidth() * getMaxHeight() * 3;
 	}
 
 	IFrameDescription *desc;
-	m_source->CreateFrameDescription(m_format, &desc);
+	if (FAILED(getSource()->CreateFrameDescription(m_format, &desc))) {
+		return 0;
+	}
 
 	unsigned int bpp, ppf;
 	desc->get_BytesPerPixel(&bpp);
 	desc->get_LengthInPixels(&ppf);
+	desc->Release();
 
-	m_frameSize = bpp * ppf;
+	return bpp * ppf;
+}
 
-	if (FAILED(m_source->OpenReader(&m_reader))) {
-		imaqkit::adaptorError(this, "ColourAdapter:openDevice", "Unable to get frame reader from color source.");
-		closeDevice();
-		return false;
+HRESULT ColourAdapter::copyFrameData(IColorFrame *frame, BYTE *data, unsigned int size) {
+	if (m_depthOutput) {
+		return copyDepthFrame(data);
 	}
-
-	m_aquireThread = CreateThread(NULL, 0, aquireThread, this, 0, &m_aquireThreadID);
-	if (m_aquireThread == NULL) {
-		closeDevice();
-		return false;
+	if (m_demosaic) {
+		return copyDemosaicFrame(frame, data);
+	}
+	if (!writesFrameInPlace()) {
+		return frame->CopyConvertedFrameDataToArray(size, data, m_format);
 	}
 
-	while (PostThreadMessage(m_aquireThreadID, WM_USER + 1, 0, 0) == 0)
-		Sleep(1);
-
-	return true;
-}
-
-DWORD WINAPI ColourAdapter::aquireThread(void* param) {
-	ColourAdapter *adaptor = reinterpret_cast<ColourAdapter*>(param);
+	//The sensor delivers YUY2; read it in place and convert it here if needed
+	ColorImageFormat rawFormat;
+	if (FAILED(frame->get_RawColorImageFormat(&rawFormat)) || rawFormat != ColorImageFormat::ColorImageFormat_Yuy2) {
+		return E_UNEXPECTED;
+	}
 
-	MSG msg;
+	BYTE *buffer;
+	unsigned int capacity;
+	HRESULT hr = Traits::accessFrameData(frame, &buffer, &capacity);
+	if (FAILED(hr)) {
+		return hr;
+	}
+	if (capacity < colourWidth * colourHeight * 2) {
+		return E_UNEXPECTED;
+	}
 
-	ColorImageFormat format = adaptor->getFormat();
+	int originX, originY, width, height;
+	getRegion(originX, originY, width, height);
 
-	unsigned int frameSize = adaptor->getFrameSize();
-	BYTE *data = new BYTE[frameSize];
+	CopyRowsTask task(this, buffer, data);
+	m_workers->run(task, height);
+	return S_OK;
+}
 
-	
+void ColourAdapter::copyRows(const BYTE *yuy2, int first, int last, BYTE *data) const {
+	int originX, originY, width, height;
+	getRegion(originX, originY, width, height);
 
-	while (GetMessage(&msg, NULL, 0, 0) > 0) {
-		switch (msg.message) {
-		case WM_USER:
-			while (adaptor->isAcquisitionNotComplete() && adaptor->aquireFrame()) {
-				WAITABLE_HANDLE frameEvent = adaptor->getFrameEvent();
-				HANDLE handles[] = { reinterpret_cast <HANDLE>(frameEvent) };
-				int idx;
+	if (m_demosaic && m_edgeAware) {
+		colourconversion::demosaicEdgeAware(&m_mosaic[0], &m_green[0], colourWidth, colourHeight,
+			originX, originY + first, width, last - first, data + first * width * 3);
+	}
+	else if (m_demosaic) {
+		colourconversion::demosaicBilinear(&m_mosaic[0], colourWidth, colourHeight,
+			originX, originY + first, width, last - first, data + first * width * 3);
+	}
+	//Each band fills its own rows of all three planes
+	else if (m_planar && m_scale == 1) {
+		colourconversion::convertYuy2ToPlanar(yuy2, colourWidth, m_matrix,
+			originX, originY + first, width, last - first, width * height, data + first * width);
+	}
+	else if (m_planar) {
+		colourconversion::downscaleYuy2ToPlanar(yuy2, colourWidth, m_scale, m_matrix,
+			originX, originY + first, width, last - first, width * height, data + first * width);
+	}
+	else if (m_rgb24 && m_scale == 1) {
+		colourconversion::convertYuy2ToRgb24(yuy2, colourWidth, m_matrix,
+			originX, originY + first, width, last - first, data + first * width * 3);
+	}
+	else if (m_rgb24) {
+		colourconversion::downscaleYuy2ToRgb24(yuy2, colourWidth, m_scale, m_matrix,
+			originX, originY + first, width, last - first, data + first * width * 3);
+	}
+	else {
+		//setROI keeps the region on whole pixel pairs
+		int top = originY + first;
+		copyRegion(yuy2 + top * colourWidth * 2, top, last - first, data);
+	}
+}
 
-				idx = WaitForMultipleObjects(1, handles, FALSE, 100);
-				switch (idx)
-				{
-				case WAIT_TIMEOUT:
-					continue;
-				case WAIT_OBJECT_0:
-					IColorFrameArrivedEventArgs *args;
-					if (FAILED(adaptor->getReader()->GetFrameArrivedEventData(frameEvent, &args))) {
-						imaqkit::adaptorWarn("ColourAdapter:aquire", "Unable to aquire event data.");
-						continue;
-					}
+HRESULT ColourAdapter::copyDemosaicFrame(IColorFrame *frame, BYTE *data) {
+	HRESULT hr = frame->CopyConvertedFrameDataToArray(static_cast<UINT>(m_mosaic.size()), &m_mosaic[0],
+		ColorImageFormat::ColorImageFormat_Bayer);
+	if (FAILED(hr)) {
+		return hr;
+	}
 
-					IColorFrameReference *frameRef;
-					args->get_FrameReference(&frameRef);
+	int originX, originY, width, height;
+	getRegion(originX, originY, width, height);
 
-					IColorFrame *frame;
-					frameRef->AcquireFrame(&frame);
+	//Red and blue next to the region need green from the rows around it
+	if (m_edgeAware) {
+		int top = originY > 0 ? originY - 1 : 0;
+		int bottom = originY + height < colourHeight ? originY + height + 1 : colourHeight;
 
-					frame->CopyConvertedFrameDataToArray(frameSize, data, format);
+		GreenTask green(&m_mosaic[0], top, &m_green[0]);
+		m_workers->run(green, bottom - top);
+	}
 
-					frame->Release();
-					frameRef->Release();
-					args->Release();
+	CopyRowsTask task(this, nullptr, data);
+	m_workers->run(task, height);
+	return S_OK;
+}
 
-					if (adaptor->isSendFrame()) {
-						imaqkit::frametypes::FRAMETYPE frameType = adaptor->getFrameType();
-						int imWidth = adaptor->getMaxWidth();
-						int imHeight = adaptor->getMaxHeight();
+//Colour frames without a new depth frame render the previous one again
+HRESULT ColourAdapter::copyDepthFrame(BYTE *data) {
+	IDepthFrame *depthFrame;
+	if (SUCCEEDED(m_depthReader->AcquireLatestFrame(&depthFrame))) {
+		UINT capacity;
+		UINT16 *depth;
+		HRESULT hr = depthFrame->AccessUnderlyingBuffer(&capacity, &depth);
+
+		if (SUCCEEDED(hr) && capacity >= depthPixels) {
+			m_hasDepth = SUCCEEDED(m_mapper->MapDepthFrameToColorSpace(depthPixels, depth,
+				depthPixels, &m_colourPoints[0]));
+
+			if (m_hasDepth) {
+				memcpy(&m_depth[0], depth, depthPixels * sizeof(UINT16));
+				depthFrame->get_RelativeTime(&m_depthTime);
+				depthconversion::colourRowBounds(&m_colourPoints[0], depthWidth, depthHeight,
+					&m_rowTop[0], &m_rowBottom[0]);
+			}
+		}
 
-						imaqkit::IAdaptorFrame *frame =
-							adaptor->getEngine()->makeFrame(frameType, imWidth, imHeight);
+		depthFrame->Release();
+	}
 
-						frame->setImage(data, imWidth, imHeight, 0, 0);
+	if (!m_hasDepth) {
+		return E_PENDING;
+	}
 
-						frame->setTime(imaqkit::getCurrentTime());
+	int originX, originY, width, height;
+	getRegion(originX, originY, width, height);
 
-						adaptor->getEngine()->receiveFrame(frame);
-					}
+	depthconversion::ColourMapping mapping = { &m_depth[0], &m_colourPoints[0],
+		&m_rowTop[0], &m_rowBottom[0], depthWidth, depthHeight };
 
-					adaptor->incrementFrameCount();
-					break;
+	DepthSplatTask task(mapping, originX, originY, width, reinterpret_cast<UINT16*>(data));
+	m_workers->run(task, height);
 
-				default:
-					break;
-				}
-			}
-			adaptor->notifyCaptureFinished();
-			break;
+	return S_OK;
+}
 
-		default:
-			break;
-		}
-	}
-	return 0;
+bool ColourAdapter::writesFrameInPlace() const {
+	return m_depthOutput || m_demosaic || m_format == ColorImageFormat::ColorImageFormat_Yuy2;
 }
 
-bool ColourAdapter::closeDevice() {
-	
-	if (!isOpen()) {
-		return true;
+//Exposure and frame interval are in 100 ns ticks, like RelativeTime
+void ColourAdapter::getFrameMetadata(IColorFrame *frame, FrameMetadata &metadata) {
+	if (m_depthOutput) {
+		metadata.add("DepthRelativeTime", static_cast<double>(m_depthTime));
 	}
 
-	if (m_aquireThread) {
-		PostThreadMessage(m_aquireThreadID, WM_QUIT, 0, 0);
+	IColorCameraSettings *settings;
+	if (FAILED(frame->get_ColorCameraSettings(&settings))) {
+		return;
+	}
 
-		WaitForSingleObject(m_aquireThread, 10000);
+	TIMESPAN exposure, interval;
+	float gain, gamma;
 
-		CloseHandle(m_aquireThread);
-		m_aquireThread = NULL;
+	if (SUCCEEDED(settings->get_ExposureTime(&exposure))) {
+		metadata.add("ExposureTime", static_cast<double>(exposure));
 	}
-
-	BOOLEAN open;
-	if (FAILED(m_sensor->get_IsOpen(&open))) {
-		imaqkit::adaptorError(this, "ColourAdapter:closeDevice", "Unable to check device status.");
+	if (SUCCEEDED(settings->get_Gain(&gain))) {
+		metadata.add("Gain", gain);
 	}
-
-	if (open && FAILED(m_sensor->Close())) {
-		imaqkit::adaptorError(this, "ColourAdapter:closeDevice", "Unable to close kinect device.");
+	if (SUCCEEDED(settings->get_Gamma(&gamma))) {
+		metadata.add("Gamma", gamma);
 	}
-	
-	return true;
+	if (SUCCEEDED(settings->get_FrameInterval(&interval))) {
+		metadata.add("FrameInterval", static_cast<double>(interval));
+	}
+
+	settings->Release();
 }
 
 imaqkit::frametypes::FRAMETYPE ColourAdapter::getFrameType() const { 
+	if (m_depthOutput) {
+		return imaqkit::frametypes::MONO16;
+	}
+	if (m_planar) {
+		return imaqkit::frametypes::RGB24_PLANAR;
+	}
+	if (m_rgb24) {
+		return imaqkit::frametypes::RGB24_PACKED;
+	}
+
 	switch (m_format)
 	{
 	case ColorImageFormat::ColorImageFormat_Bayer:
@@ -238,48 +501,6 @@ imaqkit::frametypes::FRAMETYPE ColourAdapter::getFrameType() const {
 	}
 	
 }
-int ColourAdapter::getMaxHeight() const { return 1080; }
-int ColourAdapter::getMaxWidth() const { return 1920; }
-int ColourAdapter::getNumberOfBands() const { return 3; }
-
-bool ColourAdapter::startCapture() {
-
-	if (!isOpen()) {
-		return false;
-	}
-
-	if (isAcquiring()) {
-		return true;
-	}
-
-	m_captureFinished = false;
-
-	if (FAILED(m_reader->SubscribeFrameArrived(&m_frameEvent)))	{
-		imaqkit::adaptorError(this, "DepthAdapter:startCapture", "Unable to subscribe to frame arrived event.");
-	}
-
-	m_aquireFrame = true;
-
-	PostThreadMessage(m_aquireThreadID, WM_USER, 0, 0);
-
-	return true;
-}
-bool ColourAdapter::stopCapture() {
-	if (!isOpen()) {
-		return true;
-	}
-
-	if (!isAcquiring()) {
-		return true;
-	}
-
-	m_reader->UnsubscribeFrameArrived(m_frameEvent);
-	m_aquireFrame = false;
-
-	int count = 0;
-	while (!m_captureFinished && count++ < 100) {
-		Sleep(1);
-	}
-
-	return true;
-}
\ No newline at end of file
+int ColourAdapter::getMaxHeight() const { return colourHeight / m_scale; }
+int ColourAdapter::getMaxWidth() const { return colourWidth / m_scale; }
+int ColourAdapter::getNumberOfBands() const { return m_depthOutput ? 1 : 3; }
@@ -0,0 +1,789 @@
+#include "../include/ColourConversion.h"
+
+#include <emmintrin.h>
+#include <intrin.h>
+
+namespace {
+	using colourconversion::Coefficients;
+
+	//Video range to full range RGB; fixed point values are the floats
+	//scaled by 8192
+	const Coefficients bt601 = {
+		1.164383f, 1.596027f, -0.391762f, -0.812968f, 2.017232f,
+		9539, 13075, -3209, -6660, 16525
+	};
+	const Coefficients bt709 = {
+		1.164383f, 1.792741f, -0.213249f, -0.532909f, 2.112402f,
+		9539, 14686, -1747, -4366, 17305
+	};
+
+	const float lumaOffset = 16.0f;
+
+	bool detectAvx2() {
+		int info[4];
+		__cpuid(info, 0);
+		if (info[0] < 7) {
+			return false;
+		}
+
+		//The OS must save the YMM registers as well as the processor having AVX
+		__cpuid(info, 1);
+		const int osxsave = 1 << 27;
+		const int avx = 1 << 28;
+		if ((info[2] & osxsave) == 0 || (info[2] & avx) == 0 || (_xgetbv(0) & 6) != 6) {
+			return false;
+		}
+
+		__cpuidex(info, 7, 0);
+		return (info[1] & (1 << 5)) != 0;
+	}
+
+	const bool avx2Supported = detectAvx2();
+
+	inline BYTE clampByte(float value) {
+		if (value <= 0) {
+			return 0;
+		}
+		if (value >= 255) {
+			return 255;
+		}
+		return static_cast<BYTE>(value + 0.5f);
+	}
+
+	//Channels are channelStride bytes apart: 1 for packed RGB24, the plane
+	//size for planar
+	inline void storeRgb(const Coefficients &c, float y, float u, float v, BYTE *rgb, size_t channelStride = 1) {
+		float luma = c.lumaScale * (y - lumaOffset);
+		rgb[0] = clampByte(luma + c.redFromV * v);
+		rgb[channelStride] = clampByte(luma + c.greenFromU * u + c.greenFromV * v);
+		rgb[channelStride * 2] = clampByte(luma + c.blueFromU * u);
+	}
+
+	//Scalar path of the full resolution conversions for count pixels
+	//starting at pixel first of the pair at source
+	void convertPixels(const Coefficients &c, const BYTE *source, int first, int count,
+		BYTE *rgb, size_t channelStride, int pixelStep) {
+
+		for (int i = first; i < first + count; i++) {
+			const BYTE *pair = source + (i / 2) * 4;
+			storeRgb(c, pair[(i % 2) * 2], pair[1] - 128.0f, pair[3] - 128.0f, rgb, channelStride);
+			rgb += pixelStep;
+		}
+	}
+
+	//Writes the low 12 bytes of value
+	inline void store12(__m128i value, BYTE *rgb) {
+		_mm_storel_epi64(reinterpret_cast<__m128i*>(rgb), value);
+		*reinterpret_cast<int*>(rgb + 8) = _mm_cvtsi128_si32(_mm_srli_si128(value, 8));
+	}
+
+	//Squeezes four 0x00BBGGRR pixels into 12 bytes of RGB24
+	inline __m128i packRgb24(__m128i pixels) {
+		const __m128i lowPixel = _mm_set_epi32(0, 0x00FFFFFF, 0, 0x00FFFFFF);
+		const __m128i highPixel = _mm_set_epi32(0x0000FFFF, static_cast<int>(0xFF000000), 0x0000FFFF, static_cast<int>(0xFF000000));
+
+		//Six bytes per 64-bit lane, then the lanes joined
+		__m128i lanes = _mm_or_si128(_mm_and_si128(pixels, lowPixel),
+			_mm_and_si128(_mm_srli_epi64(pixels, 8), highPixel));
+		return _mm_or_si128(_mm_move_epi64(lanes),
+			_mm_slli_si128(_mm_unpackhi_epi64(lanes, _mm_setzero_si128()), 6));
+	}
+
+	//Converts the eight pixels of 16 bytes of YUY2 to 16-bit R, G and B in
+	//Q4 fixed point
+	inline void convertEight(__m128i yuy2, const Coefficients &c, __m128i &r, __m128i &g, __m128i &b) {
+		const __m128i lumaMask = _mm_set1_epi16(0x00FF);
+		const __m128i lumaOffsetVector = _mm_set1_epi16(16);
+		const __m128i chromaOffset = _mm_set1_epi16(128);
+		const __m128i round = _mm_set1_epi16(8);
+
+		//Luma per pixel, chroma repeated for both pixels of its pair;
+		//all scaled by 128 so mulhi by Q13 leaves Q4
+		__m128i y = _mm_slli_epi16(_mm_sub_epi16(_mm_and_si128(yuy2, lumaMask), lumaOffsetVector), 7);
+		__m128i uv = _mm_slli_epi16(_mm_sub_epi16(_mm_srli_epi16(yuy2, 8), chromaOffset), 7);
+		__m128i u = _mm_shufflehi_epi16(_mm_shufflelo_epi16(uv, _MM_SHUFFLE(2, 2, 0, 0)), _MM_SHUFFLE(2, 2, 0, 0));
+		__m128i v = _mm_shufflehi_epi16(_mm_shufflelo_epi16(uv, _MM_SHUFFLE(3, 3, 1, 1)), _MM_SHUFFLE(3, 3, 1, 1));
+
+		__m128i luma = _mm_add_epi16(_mm_mulhi_epi16(y, _mm_set1_epi16(c.fixedLumaScale)), round);
+		r = _mm_srai_epi16(_mm_add_epi16(luma, _mm_mulhi_epi16(v, _mm_set1_epi16(c.fixedRedFromV))), 4);
+		g = _mm_srai_epi16(_mm_add_epi16(luma,
+			_mm_add_epi16(_mm_mulhi_epi16(u, _mm_set1_epi16(c.fixedGreenFromU)),
+				_mm_mulhi_epi16(v, _mm_set1_epi16(c.fixedGreenFromV)))), 4);
+		b = _mm_srai_epi16(_mm_add_epi16(luma, _mm_mulhi_epi16(u, _mm_set1_epi16(c.fixedBlueFromU))), 4);
+	}
+
+	//SSE2 path of convertYuy2ToRgb24; eight pixels per step in Q4 fixed
+	//point. Returns the number of pairs converted.
+	int convertPairsSse2(const BYTE *source, int pairs, const Coefficients &c, BYTE *rgb) {
+		const __m128i zero = _mm_setzero_si128();
+		int pair = 0;
+
+		for (; pair + 4 <= pairs; pair += 4) {
+			__m128i r, g, b;
+			convertEight(_mm_loadu_si128(reinterpret_cast<const __m128i*>(source + pair * 4)), c, r, g, b);
+
+			//Interleave into 0x00BBGGRR pixels
+			__m128i redBlue = _mm_packus_epi16(r, b);
+			__m128i redGreen = _mm_unpacklo_epi8(redBlue, _mm_packus_epi16(g, zero));
+			__m128i blue = _mm_unpackhi_epi8(redBlue, zero);
+
+			store12(packRgb24(_mm_unpacklo_epi16(redGreen, blue)), rgb);
+			store12(packRgb24(_mm_unpackhi_epi16(redGreen, blue)), rgb + 12);
+			rgb += 24;
+		}
+
+		return pair;
+	}
+
+	//SSE2 path of convertYuy2ToPlanar; sixteen pixels per step, each
+	//channel saturated straight into its own plane. Returns the number of
+	//pairs converted.
+	int convertPairsPlanarSse2(const BYTE *source, int pairs, const Coefficients &c,
+		BYTE *red, BYTE *green, BYTE *blue) {
+
+		int pair = 0;
+
+		for (; pair + 8 <= pairs; pair += 8) {
+			__m128i r0, g0, b0, r1, g1, b1;
+			convertEight(_mm_loadu_si128(reinterpret_cast<const __m128i*>(source + pair * 4)), c, r0, g0, b0);
+			convertEight(_mm_loadu_si128(reinterpret_cast<const __m128i*>(source + pair * 4 + 16)), c, r1, g1, b1);
+
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(red + pair * 2), _mm_packus_epi16(r0, r1));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(green + pair * 2), _mm_packus_epi16(g0, g1));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(blue + pair * 2), _mm_packus_epi16(b0, b1));
+		}
+
+		return pair;
+	}
+
+	//Reference path, also used for the pixels left over by the vector loop
+	void downscalePixel(const Coefficients &c, const BYTE *block, size_t stride, int factor,
+		BYTE *rgb, size_t channelStride) {
+		int ySum = 0, uSum = 0, vSum = 0;
+
+		for (int row = 0; row < factor; row++) {
+			const BYTE *src = block + row * stride;
+			for (int i = 0; i < factor * 2; i += 4) {
+				ySum += src[i] + src[i + 2];
+				uSum += src[i + 1];
+				vSum += src[i + 3];
+			}
+		}
+
+		float lumaCount = static_cast<float>(factor * factor);
+		float chromaCount = lumaCount / 2;
+		storeRgb(c, ySum / lumaCount, uSum / chromaCount - 128, vSum / chromaCount - 128, rgb, channelStride);
+	}
+
+	//Adds 16 bytes of each source row as 16-bit lanes
+	inline void sumRows(const BYTE *src, size_t stride, int rows, __m128i &lo, __m128i &hi) {
+		const __m128i zero = _mm_setzero_si128();
+		lo = zero;
+		hi = zero;
+
+		for (int row = 0; row < rows; row++) {
+			__m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + row * stride));
+			lo = _mm_add_epi16(lo, _mm_unpacklo_epi8(bytes, zero));
+			hi = _mm_add_epi16(hi, _mm_unpackhi_epi8(bytes, zero));
+		}
+	}
+
+	//Luma of the addressed pixel and chroma of its pair
+	inline void samplePixel(const BYTE *source, size_t stride, int x, int y, int &luma, int &u, int &v) {
+		const BYTE *pair = source + y * stride + (x & ~1) * 2;
+		luma = pair[(x & 1) * 2];
+		u = pair[1];
+		v = pair[3];
+	}
+
+	inline __m128i evenLanes(__m128i a, __m128i b) {
+		return _mm_castps_si128(_mm_shuffle_ps(_mm_castsi128_ps(a), _mm_castsi128_ps(b), _MM_SHUFFLE(2, 0, 2, 0)));
+	}
+
+	inline __m128i oddLanes(__m128i a, __m128i b) {
+		return _mm_castps_si128(_mm_shuffle_ps(_mm_castsi128_ps(a), _mm_castsi128_ps(b), _MM_SHUFFLE(3, 1, 3, 1)));
+	}
+
+	//Luma and chroma sums of the four YUY2 pixel pairs in 16 bytes of
+	//source, summed over rows
+	inline void sumPairs(const BYTE *src, size_t stride, int rows, __m128i &y, __m128i &u, __m128i &v) {
+		const __m128i lumaMask = _mm_set_epi16(0, 1, 0, 1, 0, 1, 0, 1);
+		const __m128i chromaMask = _mm_set_epi16(1, 0, 1, 0, 1, 0, 1, 0);
+
+		__m128i lo, hi;
+		sumRows(src, stride, rows, lo, hi);
+
+		//Per pixel luma and alternating U, V of each half
+		__m128i lumaLo = _mm_madd_epi16(lo, lumaMask);
+		__m128i lumaHi = _mm_madd_epi16(hi, lumaMask);
+		__m128i chromaLo = _mm_madd_epi16(lo, chromaMask);
+		__m128i chromaHi = _mm_madd_epi16(hi, chromaMask);
+
+		y = _mm_add_epi32(evenLanes(lumaLo, lumaHi), oddLanes(lumaLo, lumaHi));
+		u = evenLanes(chromaLo, chromaHi);
+		v = oddLanes(chromaLo, chromaHi);
+	}
+
+	inline __m128i convert(const Coefficients &c, __m128 y, __m128 u, __m128 v, __m128 &g, __m128 &b) {
+		__m128 luma = _mm_mul_ps(_mm_set1_ps(c.lumaScale), _mm_sub_ps(y, _mm_set1_ps(lumaOffset)));
+		__m128 r = _mm_add_ps(luma, _mm_mul_ps(_mm_set1_ps(c.redFromV), v));
+		g = _mm_add_ps(luma, _mm_add_ps(_mm_mul_ps(_mm_set1_ps(c.greenFromU), u), _mm_mul_ps(_mm_set1_ps(c.greenFromV), v)));
+		b = _mm_add_ps(luma, _mm_mul_ps(_mm_set1_ps(c.blueFromU), u));
+		return _mm_cvtps_epi32(r);
+	}
+
+	//Converts four averaged pixels and writes them pixelStep bytes apart,
+	//with channels channelStride bytes apart
+	inline void storeRgb4(const Coefficients &c, __m128i ySum, __m128i uSum, __m128i vSum, float lumaCount, float chromaCount,
+		BYTE *rgb, size_t channelStride = 1, int pixelStep = 3) {
+		__m128 lumaNorm = _mm_set1_ps(1.0f / lumaCount);
+		__m128 chromaNorm = _mm_set1_ps(1.0f / chromaCount);
+		__m128 half = _mm_set1_ps(128.0f);
+
+		__m128 y = _mm_mul_ps(_mm_cvtepi32_ps(ySum), lumaNorm);
+		__m128 u = _mm_sub_ps(_mm_mul_ps(_mm_cvtepi32_ps(uSum), chromaNorm), half);
+		__m128 v = _mm_sub_ps(_mm_mul_ps(_mm_cvtepi32_ps(vSum), chromaNorm), half);
+
+		__m128 g, b;
+		__m128i r = convert(c, y, u, v, g, b);
+
+		__m128i redGreen = _mm_packs_epi32(r, _mm_cvtps_epi32(g));
+		__m128i blue = _mm_packs_epi32(_mm_cvtps_epi32(b), _mm_cvtps_epi32(b));
+		__m128i packed = _mm_packus_epi16(redGreen, blue);
+
+		BYTE channels[16];
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(channels), packed);
+
+		for (int i = 0; i < 4; i++) {
+			rgb[i * pixelStep] = channels[i];
+			rgb[i * pixelStep + channelStride] = channels[4 + i];
+			rgb[i * pixelStep + channelStride * 2] = channels[8 + i];
+		}
+	}
+
+	//Shared by the packed and planar downscales
+	void downscaleRows(const BYTE *source, int sourceWidth, int factor, const Coefficients &c,
+		int originX, int originY, int width, int height, BYTE *rgb, size_t channelStride, int pixelStep) {
+
+		size_t stride = sourceWidth * 2;
+		float lumaCount = static_cast<float>(factor * factor);
+		float chromaCount = lumaCount / 2;
+
+		for (int row = 0; row < height; row++) {
+			const BYTE *src = source + (originY + row) * factor * stride + originX * factor * 2;
+			BYTE *dst = rgb + row * width * pixelStep;
+			int x = 0;
+
+			if (factor == 2) {
+				//One pixel pair per output pixel, 16 source bytes per four
+				for (; x + 4 <= width; x += 4) {
+					__m128i y, u, v;
+					sumPairs(src, stride, 2, y, u, v);
+					storeRgb4(c, y, u, v, lumaCount, chromaCount, dst, channelStride, pixelStep);
+
+					src += 16;
+					dst += pixelStep * 4;
+				}
+			}
+			else if (factor == 4) {
+				//Two pixel pairs per output pixel, 32 source bytes per four
+				for (; x + 4 <= width; x += 4) {
+					__m128i y0, u0, v0, y1, u1, v1;
+					sumPairs(src, stride, 4, y0, u0, v0);
+					sumPairs(src + 16, stride, 4, y1, u1, v1);
+
+					__m128i y = _mm_add_epi32(evenLanes(y0, y1), oddLanes(y0, y1));
+					__m128i u = _mm_add_epi32(evenLanes(u0, u1), oddLanes(u0, u1));
+					__m128i v = _mm_add_epi32(evenLanes(v0, v1), oddLanes(v0, v1));
+					storeRgb4(c, y, u, v, lumaCount, chromaCount, dst, channelStride, pixelStep);
+
+					src += 32;
+					dst += pixelStep * 4;
+				}
+			}
+
+			for (; x < width; x++) {
+				downscalePixel(c, src, stride, factor, dst, channelStride);
+				src += factor * 2;
+				dst += pixelStep;
+			}
+		}
+	}
+
+	//Mirrors an index past either end back inside; a mirrored mosaic site
+	//keeps its colour
+	inline int reflect(int i, int size) {
+		if (i < 0) {
+			return -i;
+		}
+		if (i >= size) {
+			return 2 * (size - 1) - i;
+		}
+		return i;
+	}
+
+	inline const BYTE *mosaicRow(const BYTE *mosaic, int width, int height, int y) {
+		return mosaic + reflect(y, height) * width;
+	}
+
+	inline int clampInt(int value) {
+		return value < 0 ? 0 : value > 255 ? 255 : value;
+	}
+
+	//Values needed at one site, from the sites around it. For bilinear they
+	//are mosaic values; for edge-aware they are colour differences from
+	//the interpolated green.
+	struct Neighbourhood {
+		int centre;
+		int horizontal;
+		int vertical;
+		int cross;
+		int diagonal;
+	};
+
+	//Assigns the interpolated values to channels by the site's place in
+	//the GRBG pattern: G R on even rows, B G on odd rows
+	inline void storeSite(int x, int y, const Neighbourhood &n, BYTE *rgb) {
+		int r, g, b;
+		if ((y & 1) == 0) {
+			if ((x & 1) == 0) { r = n.horizontal; g = n.centre; b = n.vertical; }
+			else { r = n.centre; g = n.cross; b = n.diagonal; }
+		}
+		else {
+			if ((x & 1) == 0) { r = n.diagonal; g = n.cross; b = n.centre; }
+			else { r = n.vertical; g = n.centre; b = n.horizontal; }
+		}
+		rgb[0] = static_cast<BYTE>(clampInt(r));
+		rgb[1] = static_cast<BYTE>(clampInt(g));
+		rgb[2] = static_cast<BYTE>(clampInt(b));
+	}
+
+	//Scalar path of demosaicBilinear for one pixel
+	void bilinearPixel(const BYTE *mosaic, int width, int height, int x, int y, BYTE *rgb) {
+		const BYTE *above = mosaicRow(mosaic, width, height, y - 1);
+		const BYTE *row = mosaicRow(mosaic, width, height, y);
+		const BYTE *below = mosaicRow(mosaic, width, height, y + 1);
+		int left = reflect(x - 1, width);
+		int right = reflect(x + 1, width);
+
+		Neighbourhood n;
+		n.centre = row[x];
+		n.horizontal = (row[left] + row[right] + 1) >> 1;
+		n.vertical = (above[x] + below[x] + 1) >> 1;
+		n.cross = (row[left] + row[right] + above[x] + below[x] + 2) >> 2;
+		n.diagonal = (above[left] + above[right] + below[left] + below[right] + 2) >> 2;
+		storeSite(x, y, n, rgb);
+	}
+
+	//Scalar path of interpolateGreen. Red and blue sites take green along
+	//the direction of least change, corrected by the second difference of
+	//their own channel (Hamilton-Adams).
+	BYTE greenPixel(const BYTE *mosaic, int width, int height, int x, int y) {
+		const BYTE *row = mosaicRow(mosaic, width, height, y);
+		int centre = row[x];
+		if (((x + y) & 1) == 0) {
+			return static_cast<BYTE>(centre);
+		}
+
+		int left = row[reflect(x - 1, width)];
+		int right = row[reflect(x + 1, width)];
+		int up = mosaicRow(mosaic, width, height, y - 1)[x];
+		int down = mosaicRow(mosaic, width, height, y + 1)[x];
+		int laplaceH = 2 * centre - row[reflect(x - 2, width)] - row[reflect(x + 2, width)];
+		int laplaceV = 2 * centre - mosaicRow(mosaic, width, height, y - 2)[x] - mosaicRow(mosaic, width, height, y + 2)[x];
+
+		int gradientH = abs(left - right) + abs(laplaceH);
+		int gradientV = abs(up - down) + abs(laplaceV);
+		int estimateH = (2 * (left + right) + laplaceH + 2) >> 2;
+		int estimateV = (2 * (up + down) + laplaceV + 2) >> 2;
+
+		int green = gradientH < gradientV ? estimateH
+			: gradientV < gradientH ? estimateV : (estimateH + estimateV + 1) >> 1;
+		return static_cast<BYTE>(clampInt(green));
+	}
+
+	//Scalar path of demosaicEdgeAware for one pixel; red and blue are
+	//interpolated as differences from green
+	void edgeAwarePixel(const BYTE *mosaic, const BYTE *green, int width, int height, int x, int y, BYTE *rgb) {
+		int above = reflect(y - 1, height) * width;
+		int row = y * width;
+		int below = reflect(y + 1, height) * width;
+		int left = reflect(x - 1, width);
+		int right = reflect(x + 1, width);
+
+		int g = green[row + x];
+		Neighbourhood n;
+		n.centre = mosaic[row + x];
+		n.horizontal = g + ((mosaic[row + left] - green[row + left] + mosaic[row + right] - green[row + right] + 1) >> 1);
+		n.vertical = g + ((mosaic[above + x] - green[above + x] + mosaic[below + x] - green[below + x] + 1) >> 1);
+		n.cross = g;
+		n.diagonal = g + ((mosaic[above + left] - green[above + left] + mosaic[above + right] - green[above + right]
+			+ mosaic[below + left] - green[below + left] + mosaic[below + right] - green[below + right] + 2) >> 2);
+		storeSite(x, y, n, rgb);
+	}
+
+	inline __m128i load8(const BYTE *source) {
+		return _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(source)), _mm_setzero_si128());
+	}
+
+	inline __m128i select(__m128i mask, __m128i a, __m128i b) {
+		return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+	}
+
+	inline __m128i abs16(__m128i value) {
+		return _mm_max_epi16(value, _mm_sub_epi16(_mm_setzero_si128(), value));
+	}
+
+	//Saturates eight 16-bit R, G and B values and writes them as RGB24
+	inline void storeRgb8(__m128i r, __m128i g, __m128i b, BYTE *rgb) {
+		const __m128i zero = _mm_setzero_si128();
+		__m128i redGreen = _mm_unpacklo_epi8(_mm_packus_epi16(r, zero), _mm_packus_epi16(g, zero));
+		__m128i blue = _mm_unpacklo_epi8(_mm_packus_epi16(b, zero), zero);
+
+		store12(packRgb24(_mm_unpacklo_epi16(redGreen, blue)), rgb);
+		store12(packRgb24(_mm_unpackhi_epi16(redGreen, blue)), rgb + 12);
+	}
+
+	//Vector version of storeSite for eight sites starting on an even column
+	inline void storeSites8(bool evenRow, __m128i centre, __m128i horizontal, __m128i vertical,
+		__m128i cross, __m128i diagonal, BYTE *rgb) {
+
+		const __m128i evenColumns = _mm_set_epi16(0, -1, 0, -1, 0, -1, 0, -1);
+
+		if (evenRow) {
+			storeRgb8(select(evenColumns, horizontal, centre), select(evenColumns, centre, cross),
+				select(evenColumns, vertical, diagonal), rgb);
+		}
+		else {
+			storeRgb8(select(evenColumns, diagonal, vertical), select(evenColumns, cross, centre),
+				select(evenColumns, centre, horizontal), rgb);
+		}
+	}
+
+	//Vector steps read two columns either side of their eight pixels
+	const int demosaicMargin = 2;
+
+	//First column of the vector steps of a row and the column they stop
+	//before; the scalar path covers the rest
+	inline void vectorSpan(int first, int last, int width, int &vectorFirst, int &vectorLast) {
+		vectorFirst = first < demosaicMargin ? demosaicMargin : (first + 1) & ~1;
+		int end = last < width - demosaicMargin ? last : width - demosaicMargin;
+
+		if (vectorFirst >= end) {
+			vectorFirst = last;
+			vectorLast = last;
+			return;
+		}
+		vectorLast = vectorFirst + (end - vectorFirst) / 8 * 8;
+	}
+}
+
+const Coefficients &colourconversion::getCoefficients(Matrix matrix) {
+	return matrix == BT709 ? bt709 : bt601;
+}
+
+bool colourconversion::hasAvx2() {
+	return avx2Supported;
+}
+
+void colourconversion::convertYuy2ToRgb24(const BYTE *source, int sourceWidth, Matrix matrix,
+	int originX, int originY, int width, int height, BYTE *rgb, ConversionPath path) {
+
+	const Coefficients &c = getCoefficients(matrix);
+	size_t stride = sourceWidth * 2;
+
+	if (path == AUTO_PATH) {
+		path = avx2Supported ? AVX2_PATH : SSE2_PATH;
+	}
+
+	for (int row = 0; row < height; row++) {
+		const BYTE *src = source + (originY + row) * stride + (originX & ~1) * 2;
+		BYTE *dst = rgb + row * width * 3;
+		int remaining = width;
+
+		if (path == SCALAR_PATH) {
+			convertPixels(c, src, originX & 1, remaining, dst, 1, 3);
+			continue;
+		}
+
+		//A region starting on an odd column starts with half a pair
+		if ((originX & 1) != 0) {
+			convertPixels(c, src, 1, 1, dst, 1, 3);
+			src += 4;
+			dst += 3;
+			remaining--;
+		}
+
+		int pairs = 0;
+		if (path == AVX2_PATH) {
+			pairs = (remaining / 2) & ~7;
+			convertPairsAvx2(src, pairs, c, dst);
+		}
+		pairs += convertPairsSse2(src + pairs * 4, remaining / 2 - pairs, c, dst + pairs * 6);
+
+		convertPixels(c, src + pairs * 4, 0, remaining - pairs * 2, dst + pairs * 6, 1, 3);
+	}
+}
+
+void colourconversion::convertYuy2ToPlanar(const BYTE *source, int sourceWidth, Matrix matrix,
+	int originX, int originY, int width, int height, size_t planeSize, BYTE *planes, ConversionPath path) {
+
+	const Coefficients &c = getCoefficients(matrix);
+	size_t stride = sourceWidth * 2;
+
+	for (int row = 0; row < height; row++) {
+		const BYTE *src = source + (originY + row) * stride + (originX & ~1) * 2;
+		BYTE *red = planes + row * width;
+		int remaining = width;
+
+		if (path == SCALAR_PATH) {
+			convertPixels(c, src, originX & 1, remaining, red, planeSize, 1);
+			continue;
+		}
+
+		if ((originX & 1) != 0) {
+			convertPixels(c, src, 1, 1, red, planeSize, 1);
+			src += 4;
+			red++;
+			remaining--;
+		}
+
+		int pairs = convertPairsPlanarSse2(src, remaining / 2, c, red, red + planeSize, red + planeSize * 2);
+		convertPixels(c, src + pairs * 4, 0, remaining - pairs * 2, red + pairs * 2, planeSize, 1);
+	}
+}
+
+void colourconversion::downscaleYuy2ToRgb24(const BYTE *source, int sourceWidth, int factor, Matrix matrix,
+	int originX, int originY, int width, int height, BYTE *rgb) {
+
+	downscaleRows(source, sourceWidth, factor, getCoefficients(matrix),
+		originX, originY, width, height, rgb, 1, 3);
+}
+
+void colourconversion::downscaleYuy2ToPlanar(const BYTE *source, int sourceWidth, int factor, Matrix matrix,
+	int originX, int originY, int width, int height, size_t planeSize, BYTE *planes) {
+
+	downscaleRows(source, sourceWidth, factor, getCoefficients(matrix),
+		originX, originY, width, height, planes, planeSize, 1);
+}
+
+void colourconversion::gatherYuy2ToRgb24(const BYTE *source, int sourceWidth, int sourceHeight,
+	const ColorSpacePoint *points, int count, BYTE *rgb) {
+
+	const Coefficients &c = bt601;
+	size_t stride = sourceWidth * 2;
+	const float *coordinates = reinterpret_cast<const float*>(points);
+
+	const __m128 half = _mm_set1_ps(0.5f);
+	const __m128 lowerBound = _mm_setzero_ps();
+	const __m128 upperX = _mm_set1_ps(static_cast<float>(sourceWidth));
+	const __m128 upperY = _mm_set1_ps(static_cast<float>(sourceHeight));
+	int i = 0;
+
+	for (; i + 4 <= count; i += 4) {
+		__m128 points0 = _mm_loadu_ps(coordinates + i * 2);
+		__m128 points1 = _mm_loadu_ps(coordinates + i * 2 + 4);
+
+		//Nearest pixel; the comparisons are false for the -inf of unmapped points
+		__m128 x = _mm_add_ps(_mm_shuffle_ps(points0, points1, _MM_SHUFFLE(2, 0, 2, 0)), half);
+		__m128 y = _mm_add_ps(_mm_shuffle_ps(points0, points1, _MM_SHUFFLE(3, 1, 3, 1)), half);
+
+		__m128 inside = _mm_and_ps(
+			_mm_and_ps(_mm_cmpge_ps(x, lowerBound), _mm_cmplt_ps(x, upperX)),
+			_mm_and_ps(_mm_cmpge_ps(y, lowerBound), _mm_cmplt_ps(y, upperY)));
+
+		int mask = _mm_movemask_ps(inside);
+		int column[4], row[4];
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(column), _mm_cvttps_epi32(_mm_and_ps(x, inside)));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(row), _mm_cvttps_epi32(_mm_and_ps(y, inside)));
+
+		int luma[4], u[4], v[4];
+		for (int j = 0; j < 4; j++) {
+			samplePixel(source, stride, column[j], row[j], luma[j], u[j], v[j]);
+		}
+
+		storeRgb4(c, _mm_loadu_si128(reinterpret_cast<const __m128i*>(luma)),
+			_mm_loadu_si128(reinterpret_cast<const __m128i*>(u)),
+			_mm_loadu_si128(reinterpret_cast<const __m128i*>(v)), 1, 1, rgb + i * 3);
+
+		for (int j = 0; j < 4; j++) {
+			if ((mask & (1 << j)) == 0) {
+				rgb[(i + j) * 3] = 0;
+				rgb[(i + j) * 3 + 1] = 0;
+				rgb[(i + j) * 3 + 2] = 0;
+			}
+		}
+	}
+
+	for (; i < count; i++) {
+		float x = points[i].X + 0.5f;
+		float y = points[i].Y + 0.5f;
+
+		if (x >= 0 && x < sourceWidth && y >= 0 && y < sourceHeight) {
+			int luma, u, v;
+			samplePixel(source, stride, static_cast<int>(x), static_cast<int>(y), luma, u, v);
+			storeRgb(c, static_cast<float>(luma), u - 128.0f, v - 128.0f, rgb + i * 3);
+		}
+		else {
+			rgb[i * 3] = 0;
+			rgb[i * 3 + 1] = 0;
+			rgb[i * 3 + 2] = 0;
+		}
+	}
+}
+
+void colourconversion::demosaicBilinear(const BYTE *mosaic, int mosaicWidth, int mosaicHeight,
+	int originX, int originY, int width, int height, BYTE *rgb, ConversionPath path) {
+
+	const __m128i one = _mm_set1_epi16(1);
+	const __m128i two = _mm_set1_epi16(2);
+
+	for (int row = 0; row < height; row++) {
+		int y = originY + row;
+		BYTE *dst = rgb + row * width * 3;
+		int first = originX, last = originX + width;
+		int vectorFirst = last, vectorLast = last;
+
+		if (path != SCALAR_PATH) {
+			vectorSpan(first, last, mosaicWidth, vectorFirst, vectorLast);
+		}
+		for (int x = first; x < vectorFirst; x++) {
+			bilinearPixel(mosaic, mosaicWidth, mosaicHeight, x, y, dst + (x - first) * 3);
+		}
+
+		const BYTE *above = mosaicRow(mosaic, mosaicWidth, mosaicHeight, y - 1);
+		const BYTE *centre = mosaicRow(mosaic, mosaicWidth, mosaicHeight, y);
+		const BYTE *below = mosaicRow(mosaic, mosaicWidth, mosaicHeight, y + 1);
+
+		for (int x = vectorFirst; x < vectorLast; x += 8) {
+			__m128i left = load8(centre + x - 1);
+			__m128i right = load8(centre + x + 1);
+			__m128i up = load8(above + x);
+			__m128i down = load8(below + x);
+			__m128i sides = _mm_add_epi16(left, right);
+			__m128i ends = _mm_add_epi16(up, down);
+			__m128i corners = _mm_add_epi16(_mm_add_epi16(load8(above + x - 1), load8(above + x + 1)),
+				_mm_add_epi16(load8(below + x - 1), load8(below + x + 1)));
+
+			storeSites8((y & 1) == 0, load8(centre + x),
+				_mm_srli_epi16(_mm_add_epi16(sides, one), 1),
+				_mm_srli_epi16(_mm_add_epi16(ends, one), 1),
+				_mm_srli_epi16(_mm_add_epi16(_mm_add_epi16(sides, ends), two), 2),
+				_mm_srli_epi16(_mm_add_epi16(corners, two), 2),
+				dst + (x - first) * 3);
+		}
+
+		for (int x = vectorLast; x < last; x++) {
+			bilinearPixel(mosaic, mosaicWidth, mosaicHeight, x, y, dst + (x - first) * 3);
+		}
+	}
+}
+
+void colourconversion::interpolateGreen(const BYTE *mosaic, int mosaicWidth, int mosaicHeight,
+	int firstRow, int lastRow, BYTE *green, ConversionPath path) {
+
+	const __m128i evenColumns = _mm_set_epi16(0, -1, 0, -1, 0, -1, 0, -1);
+	const __m128i one = _mm_set1_epi16(1);
+	const __m128i two = _mm_set1_epi16(2);
+	const __m128i zero = _mm_setzero_si128();
+
+	for (int y = firstRow; y < lastRow; y++) {
+		BYTE *dst = green + y * mosaicWidth;
+		int vectorFirst = mosaicWidth, vectorLast = mosaicWidth;
+
+		if (path != SCALAR_PATH) {
+			vectorSpan(0, mosaicWidth, mosaicWidth, vectorFirst, vectorLast);
+		}
+		for (int x = 0; x < vectorFirst; x++) {
+			dst[x] = greenPixel(mosaic, mosaicWidth, mosaicHeight, x, y);
+		}
+
+		const BYTE *row = mosaicRow(mosaic, mosaicWidth, mosaicHeight, y);
+		const BYTE *above = mosaicRow(mosaic, mosaicWidth, mosaicHeight, y - 1);
+		const BYTE *below = mosaicRow(mosaic, mosaicWidth, mosaicHeight, y + 1);
+		const BYTE *above2 = mosaicRow(mosaic, mosaicWidth, mosaicHeight, y - 2);
+		const BYTE *below2 = mosaicRow(mosaic, mosaicWidth, mosaicHeight, y + 2);
+
+		//Green sites are the even columns of even rows and odd of odd rows
+		__m128i greenSites = (y & 1) == 0 ? evenColumns : _mm_xor_si128(evenColumns, _mm_set1_epi16(-1));
+
+		for (int x = vectorFirst; x < vectorLast; x += 8) {
+			__m128i centre = load8(row + x);
+			__m128i left = load8(row + x - 1);
+			__m128i right = load8(row + x + 1);
+			__m128i up = load8(above + x);
+			__m128i down = load8(below + x);
+
+			__m128i doubled = _mm_slli_epi16(centre, 1);
+			__m128i laplaceH = _mm_sub_epi16(doubled, _mm_add_epi16(load8(row + x - 2), load8(row + x + 2)));
+			__m128i laplaceV = _mm_sub_epi16(doubled, _mm_add_epi16(load8(above2 + x), load8(below2 + x)));
+
+			__m128i gradientH = _mm_add_epi16(abs16(_mm_sub_epi16(left, right)), abs16(laplaceH));
+			__m128i gradientV = _mm_add_epi16(abs16(_mm_sub_epi16(up, down)), abs16(laplaceV));
+			__m128i estimateH = _mm_srai_epi16(_mm_add_epi16(_mm_add_epi16(
+				_mm_slli_epi16(_mm_add_epi16(left, right), 1), laplaceH), two), 2);
+			__m128i estimateV = _mm_srai_epi16(_mm_add_epi16(_mm_add_epi16(
+				_mm_slli_epi16(_mm_add_epi16(up, down), 1), laplaceV), two), 2);
+			__m128i average = _mm_srai_epi16(_mm_add_epi16(_mm_add_epi16(estimateH, estimateV), one), 1);
+
+			__m128i estimate = select(_mm_cmplt_epi16(gradientH, gradientV), estimateH,
+				select(_mm_cmplt_epi16(gradientV, gradientH), estimateV, average));
+			_mm_storel_epi64(reinterpret_cast<__m128i*>(dst + x),
+				_mm_packus_epi16(select(greenSites, centre, estimate), zero));
+		}
+
+		for (int x = vectorLast; x < mosaicWidth; x++) {
+			dst[x] = greenPixel(mosaic, mosaicWidth, mosaicHeight, x, y);
+		}
+	}
+}
+
+void colourconversion::demosaicEdgeAware(const BYTE *mosaic, const BYTE *green, int mosaicWidth, int mosaicHeight,
+	int originX, int originY, int width, int height, BYTE *rgb, ConversionPath path) {
+
+	const __m128i one = _mm_set1_epi16(1);
+	const __m128i two = _mm_set1_epi16(2);
+
+	for (int row = 0; row < height; row++) {
+		int y = originY + row;
+		BYTE *dst = rgb + row * width * 3;
+		int first = originX, last = originX + width;
+		int vectorFirst = last, vectorLast = last;
+
+		if (path != SCALAR_PATH) {
+			vectorSpan(first, last, mosaicWidth, vectorFirst, vectorLast);
+		}
+		for (int x = first; x < vectorFirst; x++) {
+			edgeAwarePixel(mosaic, green, mosaicWidth, mosaicHeight, x, y, dst + (x - first) * 3);
+		}
+
+		size_t above = reflect(y - 1, mosaicHeight) * mosaicWidth;
+		size_t centre = y * mosaicWidth;
+		size_t below = reflect(y + 1, mosaicHeight) * mosaicWidth;
+
+		for (int x = vectorFirst; x < vectorLast; x += 8) {
+			//Colour less green at the neighbouring sites
+			__m128i left = _mm_sub_epi16(load8(mosaic + centre + x - 1), load8(green + centre + x - 1));
+			__m128i right = _mm_sub_epi16(load8(mosaic + centre + x + 1), load8(green + centre + x + 1));
+			__m128i up = _mm_sub_epi16(load8(mosaic + above + x), load8(green + above + x));
+			__m128i down = _mm_sub_epi16(load8(mosaic + below + x), load8(green + below + x));
+			__m128i corners = _mm_add_epi16(
+				_mm_add_epi16(_mm_sub_epi16(load8(mosaic + above + x - 1), load8(green + above + x - 1)),
+					_mm_sub_epi16(load8(mosaic + above + x + 1), load8(green + above + x + 1))),
+				_mm_add_epi16(_mm_sub_epi16(load8(mosaic + below + x - 1), load8(green + below + x - 1)),
+					_mm_sub_epi16(load8(mosaic + below + x + 1), load8(green + below + x + 1))));
+
+			__m128i g = load8(green + centre + x);
+			storeSites8((y & 1) == 0, load8(mosaic + centre + x),
+				_mm_add_epi16(g, _mm_srai_epi16(_mm_add_epi16(_mm_add_epi16(left, right), one), 1)),
+				_mm_add_epi16(g, _mm_srai_epi16(_mm_add_epi16(_mm_add_epi16(up, down), one), 1)),
+				g,
+				_mm_add_epi16(g, _mm_srai_epi16(_mm_add_epi16(corners, two), 2)),
+				dst + (x - first) * 3);
+		}
+
+		for (int x = vectorLast; x < last; x++) {
+			edgeAwarePixel(mosaic, green, mosaicWidth, mosaicHeight, x, y, dst + (x - first) * 3);
+		}
+	}
+}
@@ -0,0 +1,67 @@
+#include "../include/ColourConversion.h"
+
+#include <immintrin.h>
+
+//Built with AVX2 code generation; only called once hasAvx2 returns true.
+//Each 128-bit lane follows the SSE2 path of convertYuy2ToRgb24 on its own
+//eight pixels.
+namespace {
+	inline void store12(__m128i value, BYTE *rgb) {
+		_mm_storel_epi64(reinterpret_cast<__m128i*>(rgb), value);
+		*reinterpret_cast<int*>(rgb + 8) = _mm_cvtsi128_si32(_mm_srli_si128(value, 8));
+	}
+
+	//Squeezes four 0x00BBGGRR pixels per lane into 12 bytes of RGB24
+	inline __m256i packRgb24(__m256i pixels) {
+		const __m256i lowPixel = _mm256_set1_epi64x(0x0000000000FFFFFFLL);
+		const __m256i highPixel = _mm256_set1_epi64x(0x0000FFFFFF000000LL);
+
+		__m256i lanes = _mm256_or_si256(_mm256_and_si256(pixels, lowPixel),
+			_mm256_and_si256(_mm256_srli_epi64(pixels, 8), highPixel));
+		return _mm256_or_si256(_mm256_unpacklo_epi64(lanes, _mm256_setzero_si256()),
+			_mm256_slli_si256(_mm256_unpackhi_epi64(lanes, _mm256_setzero_si256()), 6));
+	}
+}
+
+void colourconversion::convertPairsAvx2(const BYTE *source, int pairs, const Coefficients &c, BYTE *rgb) {
+	const __m256i lumaMask = _mm256_set1_epi16(0x00FF);
+	const __m256i lumaOffset = _mm256_set1_epi16(16);
+	const __m256i chromaOffset = _mm256_set1_epi16(128);
+	const __m256i round = _mm256_set1_epi16(8);
+	const __m256i zero = _mm256_setzero_si256();
+
+	const __m256i lumaScale = _mm256_set1_epi16(c.fixedLumaScale);
+	const __m256i redFromV = _mm256_set1_epi16(c.fixedRedFromV);
+	const __m256i greenFromU = _mm256_set1_epi16(c.fixedGreenFromU);
+	const __m256i greenFromV = _mm256_set1_epi16(c.fixedGreenFromV);
+	const __m256i blueFromU = _mm256_set1_epi16(c.fixedBlueFromU);
+
+	for (int pair = 0; pair + 8 <= pairs; pair += 8) {
+		__m256i yuy2 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(source + pair * 4));
+
+		__m256i y = _mm256_slli_epi16(_mm256_sub_epi16(_mm256_and_si256(yuy2, lumaMask), lumaOffset), 7);
+		__m256i uv = _mm256_slli_epi16(_mm256_sub_epi16(_mm256_srli_epi16(yuy2, 8), chromaOffset), 7);
+		__m256i u = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(uv, _MM_SHUFFLE(2, 2, 0, 0)), _MM_SHUFFLE(2, 2, 0, 0));
+		__m256i v = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(uv, _MM_SHUFFLE(3, 3, 1, 1)), _MM_SHUFFLE(3, 3, 1, 1));
+
+		__m256i luma = _mm256_add_epi16(_mm256_mulhi_epi16(y, lumaScale), round);
+		__m256i r = _mm256_srai_epi16(_mm256_add_epi16(luma, _mm256_mulhi_epi16(v, redFromV)), 4);
+		__m256i g = _mm256_srai_epi16(_mm256_add_epi16(luma,
+			_mm256_add_epi16(_mm256_mulhi_epi16(u, greenFromU), _mm256_mulhi_epi16(v, greenFromV))), 4);
+		__m256i b = _mm256_srai_epi16(_mm256_add_epi16(luma, _mm256_mulhi_epi16(u, blueFromU)), 4);
+
+		__m256i redBlue = _mm256_packus_epi16(r, b);
+		__m256i redGreen = _mm256_unpacklo_epi8(redBlue, _mm256_packus_epi16(g, zero));
+		__m256i blue = _mm256_unpackhi_epi8(redBlue, zero);
+
+		__m256i low = packRgb24(_mm256_unpacklo_epi16(redGreen, blue));
+		__m256i high = packRgb24(_mm256_unpackhi_epi16(redGreen, blue));
+
+		//Pixels 0-3 and 4-7 are in the low lanes, 8-11 and 12-15 in the high
+		store12(_mm256_castsi256_si128(low), rgb);
+		store12(_mm256_castsi256_si128(high), rgb + 12);
+		store12(_mm256_extracti128_si256(low, 1), rgb + 24);
+		store12(_mm256_extracti128_si256(high, 1), rgb + 36);
+		rgb += 48;
+	}
+}
@@ -1,262 +1,221 @@
 #include "../include/DepthAdapter.h"
 
+#include "../include/DepthConversion.h"
+
+static const int depthWidth = 512;
+static const int depthHeight = 424;
+static const int depthPixels = depthWidth * depthHeight;
+
 DepthAdapter::DepthAdapter(imaqkit::IEngine* engine,
 	const KinectDeviceInfo *deviceInfo,
 	const char* formatName) 
-	:imaqkit::IAdaptor(engine),
-	m_frameEvent() {
+	:KinectAdapter(engine, deviceInfo),
+	m_output(RAW_OUTPUT),
+	m_clipMinimum(kinectprops::DEPTH_CLIP_MINIMUM_DEFAULT),
+	m_clipMaximum(kinectprops::DEPTH_CLIP_MAXIMUM_DEFAULT),
+	m_rays(nullptr),
+	m_rayCount(0),
+	m_filter(NO_FILTER),
+	m_window(kinectprops::TEMPORAL_WINDOW_DEFAULT),
+	m_slot(0) {
 
-		m_sensor = deviceInfo->getDevice();
+	if (strcmp(formatName, "FLOAT_512x424") == 0) {
+		m_output = METRES_OUTPUT;
+	}
+	else if (strcmp(formatName, "MONO8_512x424") == 0) {
+		m_output = CLIPPED_OUTPUT;
+	}
+	else if (strcmp(formatName, "XYZ_FLOAT_512x1272") == 0) {
+		m_output = POINT_CLOUD_OUTPUT;
 	}
-
-DepthAdapter::~DepthAdapter() {}
-
-const char* DepthAdapter::getDriverDescription() const {
-	return "KinectV2Depth_Driver";
-}
-const char* DepthAdapter::getDriverVersion() const {
-	return "0.0.1";
-}
-
-WAITABLE_HANDLE DepthAdapter::getFrameEvent() {
-	return m_frameEvent;
 }
 
-IKinectSensor *DepthAdapter::getSensor() const {
-	return m_sensor;
+DepthAdapter::~DepthAdapter() {
+	stopAndJoin();
 }
 
-IDepthFrameSource *DepthAdapter::getSource() const {
-	return m_source;
+const char* DepthAdapter::getDriverDescription() const {
+	return "KinectV2Depth_Driver";
 }
 
-IDepthFrameReader *DepthAdapter::getReader() const {
-	return m_reader;
-}
+bool DepthAdapter::startCapture() {
+	imaqkit::IPropContainer *props = getEngine()->getAdaptorPropContainer();
 
-unsigned int DepthAdapter::getFrameSize() const {
-	return m_frameSize;
-}
+	m_clipMinimum = static_cast<UINT16>(props->getPropValueAsInt(kinectprops::DEPTH_CLIP_MINIMUM));
+	m_clipMaximum = static_cast<UINT16>(props->getPropValueAsInt(kinectprops::DEPTH_CLIP_MAXIMUM));
+	if (m_output == CLIPPED_OUTPUT && m_clipMinimum >= m_clipMaximum) {
+		imaqkit::adaptorError(this, "DepthAdapter:startCapture", "DepthClipMinimum must be less than DepthClipMaximum.");
+		return false;
+	}
 
-bool DepthAdapter::aquireFrame() const {
-	return m_aquireFrame;
+	switch (props->getPropValueAsInt(kinectprops::TEMPORAL_FILTER)) {
+	case kinectprops::AVERAGE_ID:
+		m_filter = AVERAGE_FILTER;
+		break;
+	case kinectprops::MEDIAN_ID:
+		m_filter = MEDIAN_FILTER;
+		break;
+	case kinectprops::HOLD_INVALID_ID:
+		m_filter = HOLD_FILTER;
+		break;
+	default:
+		m_filter = NO_FILTER;
+		break;
+	}
+	m_window = props->getPropValueAsInt(kinectprops::TEMPORAL_WINDOW);
+
+	//Every capture starts the filter afresh
+	m_slot = 0;
+	m_filtered.assign(m_filter == NO_FILTER ? 0 : depthPixels, 0);
+	m_average.assign(m_filter == AVERAGE_FILTER ? depthPixels : 0, 0.0f);
+	m_history.assign(m_filter == MEDIAN_FILTER ? depthconversion::historySize(depthPixels, m_window | 1) : 0, 0);
+	m_held.assign(m_filter == HOLD_FILTER ? depthPixels : 0, 0);
+	m_heldAge.assign(m_filter == HOLD_FILTER ? depthPixels : 0, 0);
+
+	//The table belongs to the session, which may have changed since the
+	//last capture. If the calibration has not arrived yet, the capture
+	//thread fetches it with the first point cloud instead.
+	m_rays = nullptr;
+	m_rayCount = 0;
+	if (m_output == POINT_CLOUD_OUTPUT) {
+		fetchRayTable();
+	}
+
+	return KinectAdapter::startCapture();
 }
 
-void DepthAdapter::notifyCaptureFinished() {
-	m_captureFinished = true;
+unsigned int DepthAdapter::queryFrameSize() {
+	switch (m_output) {
+	case METRES_OUTPUT:
+		return depthWidth * depthHeight * sizeof(float);
+	case POINT_CLOUD_OUTPUT:
+		return depthWidth * depthHeight * 3 * sizeof(float);
+	case CLIPPED_OUTPUT:
+		return depthWidth * depthHeight;
+	default:
+		return KinectAdapter::queryFrameSize();
+	}
 }
 
-bool DepthAdapter::openDevice() {
-
-	if (isOpen()) {
-		return true;
+HRESULT DepthAdapter::copyFrameData(IDepthFrame *frame, BYTE *data, unsigned int size) {
+	UINT capacity;
+	UINT16 *buffer;
+	HRESULT hr = frame->AccessUnderlyingBuffer(&capacity, &buffer);
+	if (FAILED(hr)) {
+		return hr;
+	}
+	if (capacity < depthPixels) {
+		return E_UNEXPECTED;
 	}
 
-	BOOLEAN open;
+	const UINT16 *depth = filterFrame(buffer);
 
-	if (FAILED(m_sensor->get_IsOpen(&open))) {
-		imaqkit::adaptorError(this, "DepthAdapter:openDevice", "Unable to determine kinect device status.");
+	if (m_output == RAW_OUTPUT) {
+		copyRegion(reinterpret_cast<const BYTE*>(depth), 0, depthHeight, data);
+		return S_OK;
 	}
-	
-	if (!open && FAILED(m_sensor->Open())) {
-		imaqkit::adaptorError(this, "DepthAdapter:openDevice", "Unable to open kinect device.");
-		closeDevice();
-		return false;
+	if (m_output == POINT_CLOUD_OUTPUT) {
+		return copyPointCloud(depth, reinterpret_cast<float*>(data));
 	}
 
-	if (FAILED(m_sensor->get_DepthFrameSource(&m_source))) {
-		imaqkit::adaptorError(this, "DepthAdapter:openDevice", "Unable to get depth frame source from kinect device.");
-		m_source = nullptr;
-		closeDevice();
-		return false;
-	}
+	int originX, originY, width, height;
+	getRegion(originX, originY, width, height);
 
-	if (FAILED(m_source->OpenReader(&m_reader))) {
-		imaqkit::adaptorError(this, "DepthAdapter:openDevice", "Unable to get frame reader from depth source.");
-		m_reader = nullptr;
-		closeDevice();
-		return false;
-	}
+	for (int y = 0; y < height; y++) {
+		const UINT16 *src = depth + (originY + y) * depthWidth + originX;
 
-	m_aquireThread = CreateThread(NULL, 0, aquireThread, this, 0, &m_aquireThreadID);
-	if (m_aquireThread == NULL) {
-		closeDevice();
-		return false;
+		if (m_output == METRES_OUTPUT) {
+			depthconversion::toMetres(src, width, reinterpret_cast<float*>(data) + y * width);
+		}
+		else {
+			depthconversion::toClippedMono8(src, width, m_clipMinimum, m_clipMaximum, data + y * width);
+		}
 	}
 
-	while (PostThreadMessage(m_aquireThreadID, WM_USER + 1, 0, 0) == 0)
-		Sleep(1);
-
-	return true;
+	return S_OK;
 }
 
-DWORD WINAPI DepthAdapter::aquireThread(void* param) {
-	DepthAdapter *adaptor = reinterpret_cast<DepthAdapter*>(param);
-
-	MSG msg;
-
-	IFrameDescription *desc;
-	adaptor->getSource()->get_FrameDescription(&desc);
-
-	unsigned int bpp, lip;
-	int h, w;
-
-	desc->get_BytesPerPixel(&bpp);
-	desc->get_LengthInPixels(&lip);
-	desc->get_Height(&h);
-	desc->get_Width(&w);
-
-	int frameSize = lip * bpp / 2;
-
-	UINT16 *data = new UINT16[frameSize];
-
-	while (GetMessage(&msg, NULL, 0, 0) > 0) {
-		switch (msg.message) {
-		case WM_USER:
-			while (adaptor->isAcquisitionNotComplete() && adaptor->aquireFrame()) {
-				WAITABLE_HANDLE frameEvent = adaptor->getFrameEvent();
-				HANDLE handles[] = { reinterpret_cast <HANDLE>(frameEvent) };
-				int idx;
-
-				idx = WaitForMultipleObjects(1, handles, FALSE, 100);
-				switch (idx)
-				{
-				case WAIT_TIMEOUT:
-					continue;
-				case WAIT_OBJECT_0:
-					IDepthFrameArrivedEventArgs *args;
-					if (FAILED(adaptor->getReader()->GetFrameArrivedEventData(frameEvent, &args))) {
-						imaqkit::adaptorWarn("DepthAdapter:aquire", "Unable to aquire event data.");
-						continue;
-					}
-
-					IDepthFrameReference *frameRef;
-					args->get_FrameReference(&frameRef);
-
-					IDepthFrame *frame;
-					frameRef->AcquireFrame(&frame);
-
-					frame->CopyFrameDataToArray(frameSize, data);
-
-					frame->Release();
-					frameRef->Release();
-					args->Release();
-
-					if (adaptor->isSendFrame()) {
-						imaqkit::frametypes::FRAMETYPE frameType = adaptor->getFrameType();
-						int imWidth = adaptor->getMaxWidth();
-						int imHeight = adaptor->getMaxHeight();
-
-						imaqkit::IAdaptorFrame *frame =
-							adaptor->getEngine()->makeFrame(frameType, imWidth, imHeight);
-
-						frame->setImage(data, imWidth, imHeight, 0, 0);
-
-						frame->setTime(imaqkit::getCurrentTime());
-
-						adaptor->getEngine()->receiveFrame(frame);
-					}
-
-					adaptor->incrementFrameCount();
-					break;
-
-				default:
-					break;
-				}
-			}
-			adaptor->notifyCaptureFinished();
-			break;
-
-		default:
-			break;
-		}
-	}
-	return 0;
+//Frames skipped by the grab interval never get here, so the window counts
+//delivered frames. Median windows are odd; an even window takes one frame
+//more.
+const UINT16 *DepthAdapter::filterFrame(const UINT16 *depth) {
+	switch (m_filter) {
+	case AVERAGE_FILTER:
+		//The weight of an average spanning the window
+		depthconversion::averageDepth(depth, depthPixels, 2.0f / (m_window + 1), &m_average[0], &m_filtered[0]);
+		break;
+	case MEDIAN_FILTER: {
+		int window = m_window | 1;
+		depthconversion::medianDepth(depth, depthPixels, window, m_slot, &m_history[0], &m_filtered[0]);
+		m_slot = (m_slot + 1) % window;
+		break;
+	}
+	case HOLD_FILTER:
+		depthconversion::holdInvalidDepth(depth, depthPixels, m_window, &m_held[0], &m_heldAge[0], &m_filtered[0]);
+		break;
+	default:
+		return depth;
+	}
+
+	return &m_filtered[0];
 }
 
-bool DepthAdapter::closeDevice() {
-	
-	if (!isOpen()) {
-		return true;
+//The X, Y and Z planes are stacked vertically, so region rows may fall in
+//any of the three
+HRESULT DepthAdapter::copyPointCloud(const UINT16 *depth, float *points) {
+	if (m_rays == nullptr) {
+		HRESULT hr = fetchRayTable();
+		if (FAILED(hr)) {
+			return hr;
+		}
 	}
 
-	if (m_aquireThread) {
-		PostThreadMessage(m_aquireThreadID, WM_QUIT, 0, 0);
+	int originX, originY, width, height;
+	getRegion(originX, originY, width, height);
 
-		WaitForSingleObject(m_aquireThread, 10000);
+	for (int y = 0; y < height; y++) {
+		int axis = (originY + y) / depthHeight;
+		int offset = ((originY + y) % depthHeight) * depthWidth + originX;
 
-		CloseHandle(m_aquireThread);
-		m_aquireThread = NULL;
+		depthconversion::toCameraSpace(depth + offset, m_rays + offset, width, axis, points + y * width);
 	}
 
-	if (m_reader) {
-		m_reader->Release();
-		m_reader = nullptr;
-	}
-	
-	if (m_source) {
-		m_source->Release();
-		m_source = nullptr;
-	}
-	
+	return S_OK;
+}
 
-	BOOLEAN open;
-	if (FAILED(m_sensor->get_IsOpen(&open))) {
-		imaqkit::adaptorError(this, "DepthAdapter:closeDevice", "Unable to check device status.");
+HRESULT DepthAdapter::fetchRayTable() {
+	const PointF *rays;
+	unsigned int rayCount;
+	HRESULT hr = getSession()->getDepthRayTable(&rays, &rayCount);
+	if (FAILED(hr)) {
+		return hr;
 	}
-
-	if (open && FAILED(m_sensor->Close())) {
-		imaqkit::adaptorError(this, "DepthAdapter:closeDevice", "Unable to close kinect device.");
+	if (rayCount < depthWidth * depthHeight) {
+		return E_UNEXPECTED;
 	}
-	
-	return true;
+
+	m_rays = rays;
+	m_rayCount = rayCount;
+	return S_OK;
 }
 
 imaqkit::frametypes::FRAMETYPE DepthAdapter::getFrameType() const { 
-	return imaqkit::frametypes::MONO12;
+	switch (m_output) {
+	case METRES_OUTPUT:
+	case POINT_CLOUD_OUTPUT:
+		return imaqkit::frametypes::FLOAT;
+	case CLIPPED_OUTPUT:
+		return imaqkit::frametypes::MONO8;
+	default:
+		return imaqkit::frametypes::MONO12;
+	}
+}
+int DepthAdapter::getMaxHeight() const {
+	return m_output == POINT_CLOUD_OUTPUT ? depthHeight * 3 : depthHeight;
 }
-int DepthAdapter::getMaxHeight() const { return 424; }
-int DepthAdapter::getMaxWidth() const { return 512; }
+int DepthAdapter::getMaxWidth() const { return depthWidth; }
 int DepthAdapter::getNumberOfBands() const { return 1; }
 
-bool DepthAdapter::startCapture() {
-
-	if (!isOpen()) {
-		return false;
-	}
-
-	if (isAcquiring()) {
-		return true;
-	}
-
-	m_captureFinished = false;
-
-	if (FAILED(m_reader->SubscribeFrameArrived(&m_frameEvent)))	{
-		imaqkit::adaptorError(this, "DepthAdapter:startCapture", "Unable to subscribe to frame arrived event.");
-	}
-
-	m_aquireFrame = true;
-
-	PostThreadMessage(m_aquireThreadID, WM_USER, 0, 0);
-
+bool DepthAdapter::writesFrameInPlace() const {
 	return true;
 }
-bool DepthAdapter::stopCapture() {
-	if (!isOpen()) {
-		return true;
-	}
-
-	if (!isAcquiring()) {
-		return true;
-	}
-
-	m_reader->UnsubscribeFrameArrived(m_frameEvent);
-	m_aquireFrame = false;
-
-	int count = 0;
-	while (!m_captureFinished && count++ < 100) {
-		Sleep(1);
-	}
-
-	return true;
-}
\ No newline at end of file
@@ -0,0 +1,505 @@
+#include "../include/DepthConversion.h"
+
+#include <cmath>
+#include <cstring>
+
+#include <emmintrin.h>
+
+namespace {
+	//Splat size in colour pixels where a neighbour has no colour position,
+	//and the limit for stretching across depth discontinuities
+	const int DEFAULT_SPLAT = 3;
+	const int MAX_SPLAT = 8;
+
+	//Unmapped pixels are at negative infinity
+	const float MAX_COORDINATE = 1.0e6f;
+
+	bool isMapped(const ColorSpacePoint &point) {
+		return point.X > -MAX_COORDINATE && point.X < MAX_COORDINATE
+			&& point.Y > -MAX_COORDINATE && point.Y < MAX_COORDINATE;
+	}
+
+	int toPixel(float coordinate) {
+		return static_cast<int>(floorf(coordinate + 0.5f));
+	}
+
+	int splatExtent(float from, float to) {
+		int extent = toPixel(to) - toPixel(from);
+		if (extent < 1) {
+			return 1;
+		}
+		return extent > MAX_SPLAT ? MAX_SPLAT : extent;
+	}
+
+	inline __m128i select(__m128i mask, __m128i a, __m128i b) {
+		return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+	}
+
+	//Rounds eight non-negative floats to UINT16; packs_epi32 saturates as
+	//signed, so the values are shifted into its range and back
+	inline __m128i packDepth(__m128 lo, __m128 hi) {
+		const __m128i offset = _mm_set1_epi32(0x8000);
+		const __m128i sign = _mm_set1_epi16(static_cast<short>(0x8000));
+
+		return _mm_xor_si128(_mm_packs_epi32(_mm_sub_epi32(_mm_cvtps_epi32(lo), offset),
+			_mm_sub_epi32(_mm_cvtps_epi32(hi), offset)), sign);
+	}
+
+	//Scalar path of medianDepth for one pixel of a history block
+	UINT16 medianOf(const UINT16 *block, int lane, int window) {
+		UINT16 readings[depthconversion::MAX_HISTORY_WINDOW];
+		int valid = 0;
+
+		for (int frame = 0; frame < window; frame++) {
+			UINT16 value = block[frame * depthconversion::HISTORY_BLOCK + lane];
+			if (value == 0) {
+				continue;
+			}
+
+			int i = valid++;
+			for (; i > 0 && readings[i - 1] > value; i--) {
+				readings[i] = readings[i - 1];
+			}
+			readings[i] = value;
+		}
+
+		return valid == 0 ? 0 : readings[(valid - 1) / 2];
+	}
+
+	inline void exchange(__m128i &a, __m128i &b) {
+		__m128i low = _mm_min_epi16(a, b);
+		b = _mm_max_epi16(a, b);
+		a = low;
+	}
+
+	//Median selection networks; only the middle value ends up in place
+	template <int Window>
+	__m128i middleOf(__m128i *v);
+
+	template <>
+	__m128i middleOf<3>(__m128i *v) {
+		exchange(v[0], v[1]); exchange(v[1], v[2]); exchange(v[0], v[1]);
+		return v[1];
+	}
+
+	template <>
+	__m128i middleOf<5>(__m128i *v) {
+		exchange(v[0], v[1]); exchange(v[3], v[4]); exchange(v[0], v[3]);
+		exchange(v[1], v[4]); exchange(v[1], v[2]); exchange(v[2], v[3]);
+		exchange(v[1], v[2]);
+		return v[2];
+	}
+
+	template <>
+	__m128i middleOf<7>(__m128i *v) {
+		exchange(v[0], v[5]); exchange(v[0], v[3]); exchange(v[1], v[6]);
+		exchange(v[2], v[4]); exchange(v[0], v[1]); exchange(v[3], v[5]);
+		exchange(v[2], v[6]); exchange(v[2], v[3]); exchange(v[3], v[6]);
+		exchange(v[4], v[5]); exchange(v[1], v[4]); exchange(v[1], v[3]);
+		exchange(v[3], v[4]);
+		return v[3];
+	}
+
+	template <>
+	__m128i middleOf<9>(__m128i *v) {
+		exchange(v[1], v[2]); exchange(v[4], v[5]); exchange(v[7], v[8]);
+		exchange(v[0], v[1]); exchange(v[3], v[4]); exchange(v[6], v[7]);
+		exchange(v[1], v[2]); exchange(v[4], v[5]); exchange(v[7], v[8]);
+		exchange(v[0], v[3]); exchange(v[5], v[8]); exchange(v[4], v[7]);
+		exchange(v[3], v[6]); exchange(v[1], v[4]); exchange(v[2], v[5]);
+		exchange(v[4], v[7]); exchange(v[4], v[2]); exchange(v[6], v[4]);
+		exchange(v[4], v[2]);
+		return v[4];
+	}
+
+	//Vector path of medianDepth over whole history blocks
+	template <int Window>
+	void medianBlocks(const UINT16 *depth, int blocks, int slot, UINT16 *history, UINT16 *filtered) {
+		//Signed comparisons order unsigned values with the sign bit flipped
+		const __m128i sign = _mm_set1_epi16(static_cast<short>(0x8000));
+		const __m128i highest = _mm_set1_epi16(0x7FFF);
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i one = _mm_set1_epi16(1);
+
+		for (int b = 0; b < blocks; b++) {
+			__m128i *block = reinterpret_cast<__m128i*>(history) + b * Window;
+			_mm_storeu_si128(block + slot, _mm_loadu_si128(reinterpret_cast<const __m128i*>(depth) + b));
+
+			__m128i readings[Window];
+			__m128i invalid = zero;
+			for (int frame = 0; frame < Window; frame++) {
+				readings[frame] = _mm_loadu_si128(block + frame);
+				invalid = _mm_sub_epi16(invalid, _mm_cmpeq_epi16(readings[frame], zero));
+			}
+
+			//Invalid readings are split between the two ends so the middle
+			//of the window is the median of the valid ones: half go low, and
+			//the odd one out too when the valid count is even
+			__m128i validEven = _mm_cmpeq_epi16(_mm_and_si128(_mm_sub_epi16(_mm_set1_epi16(Window), invalid), one), zero);
+			__m128i lowCount = _mm_add_epi16(_mm_srli_epi16(invalid, 1), _mm_and_si128(validEven, _mm_and_si128(invalid, one)));
+
+			__m128i seen = zero;
+			for (int frame = 0; frame < Window; frame++) {
+				__m128i missing = _mm_cmpeq_epi16(readings[frame], zero);
+				__m128i low = _mm_cmplt_epi16(seen, lowCount);
+				seen = _mm_sub_epi16(seen, missing);
+
+				readings[frame] = select(missing, select(low, sign, highest), _mm_xor_si128(readings[frame], sign));
+			}
+
+			//No valid reading at all gives an invalid pixel
+			__m128i median = _mm_andnot_si128(_mm_cmpeq_epi16(invalid, _mm_set1_epi16(Window)),
+				_mm_xor_si128(middleOf<Window>(readings), sign));
+
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(filtered) + b, median);
+		}
+	}
+}
+
+void depthconversion::toMetres(const UINT16 *depth, int count, float *metres) {
+	const __m128i zero = _mm_setzero_si128();
+	const __m128 scale = _mm_set1_ps(0.001f);
+	int i = 0;
+
+	for (; i + 8 <= count; i += 8) {
+		__m128i values = _mm_loadu_si128(reinterpret_cast<const __m128i*>(depth + i));
+
+		__m128 lo = _mm_cvtepi32_ps(_mm_unpacklo_epi16(values, zero));
+		__m128 hi = _mm_cvtepi32_ps(_mm_unpackhi_epi16(values, zero));
+
+		_mm_storeu_ps(metres + i, _mm_mul_ps(lo, scale));
+		_mm_storeu_ps(metres + i + 4, _mm_mul_ps(hi, scale));
+	}
+
+	for (; i < count; i++) {
+		metres[i] = depth[i] * 0.001f;
+	}
+}
+
+void depthconversion::toClippedMono8(const UINT16 *depth, int count, UINT16 minimum, UINT16 maximum, BYTE *mono) {
+	if (maximum <= minimum) {
+		maximum = minimum + 1;
+	}
+
+	float scale = 255.0f / (maximum - minimum);
+	float offset = -minimum * scale;
+
+	const __m128i zero = _mm_setzero_si128();
+	const __m128 scaleVector = _mm_set1_ps(scale);
+	const __m128 offsetVector = _mm_set1_ps(offset);
+	const __m128 low = _mm_set1_ps(minimum);
+	const __m128 high = _mm_set1_ps(maximum);
+	int i = 0;
+
+	for (; i + 16 <= count; i += 16) {
+		__m128i words[2];
+		__m128i values[2];
+		words[0] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(depth + i));
+		words[1] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(depth + i + 8));
+
+		for (int j = 0; j < 2; j++) {
+			__m128 lo = _mm_cvtepi32_ps(_mm_unpacklo_epi16(words[j], zero));
+			__m128 hi = _mm_cvtepi32_ps(_mm_unpackhi_epi16(words[j], zero));
+
+			lo = _mm_min_ps(_mm_max_ps(lo, low), high);
+			hi = _mm_min_ps(_mm_max_ps(hi, low), high);
+
+			values[j] = _mm_packs_epi32(
+				_mm_cvtps_epi32(_mm_add_ps(_mm_mul_ps(lo, scaleVector), offsetVector)),
+				_mm_cvtps_epi32(_mm_add_ps(_mm_mul_ps(hi, scaleVector), offsetVector)));
+
+			//Invalid pixels are cleared rather than clipped to the minimum
+			values[j] = _mm_andnot_si128(_mm_cmpeq_epi16(words[j], zero), values[j]);
+		}
+
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(mono + i), _mm_packus_epi16(values[0], values[1]));
+	}
+
+	for (; i < count; i++) {
+		UINT16 value = depth[i];
+
+		if (value == 0) {
+			mono[i] = 0;
+			continue;
+		}
+		if (value < minimum) {
+			value = minimum;
+		}
+		else if (value > maximum) {
+			value = maximum;
+		}
+		mono[i] = static_cast<BYTE>(value * scale + offset + 0.5f);
+	}
+}
+
+void depthconversion::toCameraSpace(const UINT16 *depth, const PointF *rays, int count, int axis, float *coordinate) {
+	if (axis == 2) {
+		toMetres(depth, count, coordinate);
+		return;
+	}
+
+	const __m128i zero = _mm_setzero_si128();
+	const __m128 scale = _mm_set1_ps(0.001f);
+	const float *table = reinterpret_cast<const float*>(rays);
+	int i = 0;
+
+	for (; i + 8 <= count; i += 8) {
+		__m128i values = _mm_loadu_si128(reinterpret_cast<const __m128i*>(depth + i));
+
+		__m128 lo = _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(values, zero)), scale);
+		__m128 hi = _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(values, zero)), scale);
+
+		//Four X, Y pairs per load; keep the requested axis
+		__m128 rays0 = _mm_loadu_ps(table + i * 2);
+		__m128 rays1 = _mm_loadu_ps(table + i * 2 + 4);
+		__m128 rays2 = _mm_loadu_ps(table + i * 2 + 8);
+		__m128 rays3 = _mm_loadu_ps(table + i * 2 + 12);
+
+		__m128 axisLo, axisHi;
+		if (axis == 0) {
+			axisLo = _mm_shuffle_ps(rays0, rays1, _MM_SHUFFLE(2, 0, 2, 0));
+			axisHi = _mm_shuffle_ps(rays2, rays3, _MM_SHUFFLE(2, 0, 2, 0));
+		}
+		else {
+			axisLo = _mm_shuffle_ps(rays0, rays1, _MM_SHUFFLE(3, 1, 3, 1));
+			axisHi = _mm_shuffle_ps(rays2, rays3, _MM_SHUFFLE(3, 1, 3, 1));
+		}
+
+		_mm_storeu_ps(coordinate + i, _mm_mul_ps(axisLo, lo));
+		_mm_storeu_ps(coordinate + i + 4, _mm_mul_ps(axisHi, hi));
+	}
+
+	for (; i < count; i++) {
+		float ray = axis == 0 ? rays[i].X : rays[i].Y;
+		coordinate[i] = ray * depth[i] * 0.001f;
+	}
+}
+
+void depthconversion::applyBodyMask(const UINT16 *depth, const BYTE *bodyIndex, int count, UINT16 *masked) {
+	const __m128i noBody = _mm_set1_epi8(static_cast<char>(0xFF));
+	int i = 0;
+
+	for (; i + 16 <= count; i += 16) {
+		__m128i index = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bodyIndex + i));
+		__m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(depth + i));
+		__m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(depth + i + 8));
+
+		//Widening the byte mask to itself gives a full word per pixel
+		__m128i empty = _mm_cmpeq_epi8(index, noBody);
+		__m128i emptyLo = _mm_unpacklo_epi8(empty, empty);
+		__m128i emptyHi = _mm_unpackhi_epi8(empty, empty);
+
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(masked + i), _mm_andnot_si128(emptyLo, lo));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(masked + i + 8), _mm_andnot_si128(emptyHi, hi));
+	}
+
+	for (; i < count; i++) {
+		masked[i] = bodyIndex[i] == 0xFF ? 0 : depth[i];
+	}
+}
+
+void depthconversion::colourRowBounds(const ColorSpacePoint *points, int width, int height, float *top, float *bottom) {
+	for (int v = 0; v < height; v++) {
+		const ColorSpacePoint *row = points + v * width;
+		top[v] = MAX_COORDINATE;
+		bottom[v] = -MAX_COORDINATE;
+
+		for (int u = 0; u < width; u++) {
+			if (!isMapped(row[u])) {
+				continue;
+			}
+			if (row[u].Y < top[v]) {
+				top[v] = row[u].Y;
+			}
+			if (row[u].Y > bottom[v]) {
+				bottom[v] = row[u].Y;
+			}
+		}
+	}
+}
+
+void depthconversion::splatToColour(const ColourMapping &mapping, int originX, int originY, int width,
+	int firstRow, int lastRow, UINT16 *colourDepth) {
+
+	memset(colourDepth + firstRow * width, 0, (lastRow - firstRow) * width * sizeof(UINT16));
+
+	//Band bounds in colour pixels
+	int left = originX;
+	int right = originX + width;
+	int top = originY + firstRow;
+	int bottom = originY + lastRow;
+
+	for (int v = 0; v < mapping.height; v++) {
+		if (mapping.rowTop[v] - 1.0f >= bottom || mapping.rowBottom[v] + MAX_SPLAT + 1.0f < top) {
+			continue;
+		}
+
+		const UINT16 *depthRow = mapping.depth + v * mapping.width;
+		const ColorSpacePoint *pointRow = mapping.points + v * mapping.width;
+		bool lastRowOfDepth = v + 1 == mapping.height;
+
+		for (int u = 0; u < mapping.width; u++) {
+			UINT16 depth = depthRow[u];
+			const ColorSpacePoint &point = pointRow[u];
+			if (depth == 0 || !isMapped(point)) {
+				continue;
+			}
+
+			int x0 = toPixel(point.X);
+			int y0 = toPixel(point.Y);
+
+			int dx = DEFAULT_SPLAT;
+			if (u + 1 < mapping.width && isMapped(pointRow[u + 1])) {
+				dx = splatExtent(point.X, pointRow[u + 1].X);
+			}
+			int dy = DEFAULT_SPLAT;
+			if (!lastRowOfDepth && isMapped(pointRow[u + mapping.width])) {
+				dy = splatExtent(point.Y, pointRow[u + mapping.width].Y);
+			}
+
+			int x1 = x0 + dx;
+			int y1 = y0 + dy;
+			x0 = x0 < left ? left : x0;
+			y0 = y0 < top ? top : y0;
+			x1 = x1 > right ? right : x1;
+			y1 = y1 > bottom ? bottom : y1;
+
+			for (int y = y0; y < y1; y++) {
+				UINT16 *target = colourDepth + (y - originY) * width - originX;
+
+				for (int x = x0; x < x1; x++) {
+					if (target[x] == 0 || depth < target[x]) {
+						target[x] = depth;
+					}
+				}
+			}
+		}
+	}
+}
+
+void depthconversion::fillRowGaps(UINT16 *row, int width, int maxGap) {
+	int x = 0;
+
+	//Leading invalid pixels have no reading on their left
+	while (x < width && row[x] == 0) {
+		x++;
+	}
+
+	while (x < width) {
+		if (row[x] != 0) {
+			x++;
+			continue;
+		}
+
+		int start = x;
+		while (x < width && row[x] == 0) {
+			x++;
+		}
+
+		if (x < width && x - start <= maxGap) {
+			UINT16 left = row[start - 1];
+			UINT16 right = row[x];
+			UINT16 fill = left > right ? left : right;
+
+			for (int i = start; i < x; i++) {
+				row[i] = fill;
+			}
+		}
+	}
+}
+
+void depthconversion::averageDepth(const UINT16 *depth, int count, float weight, float *average, UINT16 *filtered) {
+	const __m128i zero = _mm_setzero_si128();
+	const __m128 zeroFloat = _mm_setzero_ps();
+	const __m128 weights = _mm_set1_ps(weight);
+	int i = 0;
+
+	for (; i + 8 <= count; i += 8) {
+		__m128i values = _mm_loadu_si128(reinterpret_cast<const __m128i*>(depth + i));
+		__m128 halves[2] = {
+			_mm_cvtepi32_ps(_mm_unpacklo_epi16(values, zero)),
+			_mm_cvtepi32_ps(_mm_unpackhi_epi16(values, zero))
+		};
+
+		for (int half = 0; half < 2; half++) {
+			__m128 reading = halves[half];
+			__m128 previous = _mm_loadu_ps(average + i + half * 4);
+
+			//Fresh pixels take the reading outright
+			__m128 fresh = _mm_cmpeq_ps(previous, zeroFloat);
+			__m128 blended = _mm_add_ps(previous, _mm_mul_ps(weights, _mm_sub_ps(reading, previous)));
+			blended = _mm_or_ps(_mm_and_ps(fresh, reading), _mm_andnot_ps(fresh, blended));
+
+			__m128 invalid = _mm_cmpeq_ps(reading, zeroFloat);
+			halves[half] = _mm_or_ps(_mm_and_ps(invalid, previous), _mm_andnot_ps(invalid, blended));
+			_mm_storeu_ps(average + i + half * 4, halves[half]);
+		}
+
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(filtered + i), packDepth(halves[0], halves[1]));
+	}
+
+	for (; i < count; i++) {
+		if (depth[i] != 0) {
+			average[i] = average[i] == 0 ? depth[i] : average[i] + weight * (depth[i] - average[i]);
+		}
+		filtered[i] = static_cast<UINT16>(average[i] + 0.5f);
+	}
+}
+
+size_t depthconversion::historySize(int count, int window) {
+	return static_cast<size_t>((count + HISTORY_BLOCK - 1) / HISTORY_BLOCK) * HISTORY_BLOCK * window;
+}
+
+void depthconversion::medianDepth(const UINT16 *depth, int count, int window, int slot, UINT16 *history, UINT16 *filtered) {
+	int blocks = count / HISTORY_BLOCK;
+
+	switch (window) {
+	case 3: medianBlocks<3>(depth, blocks, slot, history, filtered); break;
+	case 5: medianBlocks<5>(depth, blocks, slot, history, filtered); break;
+	case 7: medianBlocks<7>(depth, blocks, slot, history, filtered); break;
+	case 9: medianBlocks<9>(depth, blocks, slot, history, filtered); break;
+	default: blocks = 0; break;
+	}
+
+	for (int i = blocks * HISTORY_BLOCK; i < count; i += HISTORY_BLOCK) {
+		UINT16 *block = history + i * window;
+		for (int lane = 0; lane < HISTORY_BLOCK && i + lane < count; lane++) {
+			block[slot * HISTORY_BLOCK + lane] = depth[i + lane];
+			filtered[i + lane] = medianOf(block, lane, window);
+		}
+	}
+}
+
+void depthconversion::holdInvalidDepth(const UINT16 *depth, int count, int maxAge, UINT16 *held, UINT16 *age, UINT16 *filtered) {
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i one = _mm_set1_epi16(1);
+	const __m128i ageLimit = _mm_set1_epi16(static_cast<short>(maxAge));
+	int i = 0;
+
+	for (; i + 8 <= count; i += 8) {
+		__m128i values = _mm_loadu_si128(reinterpret_cast<const __m128i*>(depth + i));
+		__m128i invalid = _mm_cmpeq_epi16(values, zero);
+
+		__m128i heldValues = select(invalid, _mm_loadu_si128(reinterpret_cast<const __m128i*>(held + i)), values);
+		__m128i ages = _mm_and_si128(invalid,
+			_mm_adds_epu16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(age + i)), one));
+
+		//Held readings older than maxAge are dropped
+		__m128i current = _mm_cmpeq_epi16(_mm_subs_epu16(ages, ageLimit), zero);
+
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(held + i), heldValues);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(age + i), ages);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(filtered + i), _mm_and_si128(current, heldValues));
+	}
+
+	for (; i < count; i++) {
+		if (depth[i] != 0) {
+			held[i] = depth[i];
+			age[i] = 0;
+		}
+		else if (age[i] < 0xFFFF) {
+			age[i]++;
+		}
+		filtered[i] = age[i] <= maxAge ? held[i] : 0;
+	}
+}
@@ -0,0 +1,162 @@
+#include "../include/FrameBufferPool.h"
+
+#include <memory>
+
+//The header is padded to ALIGNMENT so the buffer that follows stays aligned
+static const size_t headerSize = FrameBufferPool::ALIGNMENT;
+
+//Large page allocations need SeLockMemoryPrivilege, which an account can
+//hold but is never enabled in a process token by default. Fails unless the
+//account holds it.
+static bool enableLockMemoryPrivilege() {
+	HANDLE token;
+	if (!OpenProcessToken(GetCurrentProcess(), TOKEN_ADJUST_PRIVILEGES | TOKEN_QUERY, &token)) {
+		return false;
+	}
+
+	TOKEN_PRIVILEGES privileges;
+	privileges.PrivilegeCount = 1;
+	privileges.Privileges[0].Attributes = SE_PRIVILEGE_ENABLED;
+
+	bool enabled = false;
+	if (LookupPrivilegeValue(NULL, SE_LOCK_MEMORY_NAME, &privileges.Privileges[0].Luid)) {
+		//Succeeds with ERROR_NOT_ALL_ASSIGNED when the privilege is not held
+		enabled = AdjustTokenPrivileges(token, FALSE, &privileges, 0, NULL, NULL)
+			&& GetLastError() == ERROR_SUCCESS;
+	}
+
+	CloseHandle(token);
+	return enabled;
+}
+
+FrameBufferPool::FrameBufferPool(bool useLargePages)
+	:m_lock(imaqkit::createCriticalSection()),
+	m_useLargePages(useLargePages),
+	m_largePageSize(GetLargePageMinimum()),
+	m_hits(0),
+	m_misses(0),
+	m_bytesOutstanding(0),
+	m_bytesCached(0) {
+
+	if (m_largePageSize == 0 || (m_useLargePages && !enableLockMemoryPrivilege())) {
+		m_useLargePages = false;
+	}
+}
+
+FrameBufferPool::~FrameBufferPool() {
+	trim();
+	delete m_lock;
+}
+
+BYTE *FrameBufferPool::acquire(size_t size) {
+	size_t sizeClass = (size + SIZE_CLASS_GRANULARITY - 1) / SIZE_CLASS_GRANULARITY * SIZE_CLASS_GRANULARITY;
+
+	std::unique_ptr<imaqkit::IAutoCriticalSection> guard(imaqkit::createAutoCriticalSection(m_lock));
+
+	BYTE *buffer;
+	std::vector<BYTE*> &buffers = m_freeBuffers[sizeClass];
+	if (!buffers.empty()) {
+		buffer = buffers.back();
+		buffers.pop_back();
+		m_bytesCached -= sizeClass;
+		m_hits++;
+	}
+	else {
+		buffer = allocate(sizeClass);
+		if (buffer == nullptr) {
+			return nullptr;
+		}
+		m_misses++;
+	}
+
+	m_bytesOutstanding += sizeClass;
+	return buffer;
+}
+
+void FrameBufferPool::release(BYTE *buffer) {
+	if (buffer == nullptr) {
+		return;
+	}
+
+	BufferHeader *header = reinterpret_cast<BufferHeader*>(buffer - headerSize);
+
+	std::unique_ptr<imaqkit::IAutoCriticalSection> guard(imaqkit::createAutoCriticalSection(m_lock));
+
+	m_freeBuffers[header->sizeClass].push_back(buffer);
+	m_bytesOutstanding -= header->sizeClass;
+	m_bytesCached += header->sizeClass;
+}
+
+void FrameBufferPool::trim() {
+	std::unique_ptr<imaqkit::IAutoCriticalSection> guard(imaqkit::createAutoCriticalSection(m_lock));
+
+	for (std::map<size_t, std::vector<BYTE*> >::iterator it = m_freeBuffers.begin(); it != m_freeBuffers.end(); ++it) {
+		for (size_t i = 0; i < it->second.size(); i++) {
+			freeBuffer(it->second[i]);
+		}
+	}
+	m_freeBuffers.clear();
+	m_bytesCached = 0;
+}
+
+BYTE *FrameBufferPool::allocate(size_t sizeClass) {
+	size_t totalSize = sizeClass + headerSize;
+	BYTE *block = nullptr;
+	bool largePage = false;
+
+	if (m_useLargePages && totalSize >= m_largePageSize) {
+		size_t largeSize = (totalSize + m_largePageSize - 1) / m_largePageSize * m_largePageSize;
+		block = static_cast<BYTE*>(VirtualAlloc(NULL, largeSize, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE));
+
+		//Fails once physical memory is too fragmented for large pages, and
+		//rarely recovers, so stop trying
+		if (block == nullptr) {
+			m_useLargePages = false;
+		}
+		largePage = block != nullptr;
+	}
+
+	if (block == nullptr) {
+		block = static_cast<BYTE*>(_aligned_malloc(totalSize, ALIGNMENT));
+		if (block == nullptr) {
+			return nullptr;
+		}
+	}
+
+	BufferHeader *header = reinterpret_cast<BufferHeader*>(block);
+	header->sizeClass = sizeClass;
+	header->largePage = largePage;
+
+	return block + headerSize;
+}
+
+void FrameBufferPool::freeBuffer(BYTE *buffer) {
+	BYTE *block = buffer - headerSize;
+
+	if (reinterpret_cast<BufferHeader*>(block)->largePage) {
+		VirtualFree(block, 0, MEM_RELEASE);
+	}
+	else {
+		_aligned_free(block);
+	}
+}
+
+unsigned int FrameBufferPool::getHitCount() const {
+	std::unique_ptr<imaqkit::IAutoCriticalSection> guard(imaqkit::createAutoCriticalSection(m_lock));
+	return m_hits;
+}
+
+unsigned int FrameBufferPool::getMissCount() const {
+	std::unique_ptr<imaqkit::IAutoCriticalSection> guard(imaqkit::createAutoCriticalSection(m_lock));
+	return m_misses;
+}
+
+size_t FrameBufferPool::getBytesOutstanding() const {
+	std::unique_ptr<imaqkit::IAutoCriticalSection> guard(imaqkit::createAutoCriticalSection(m_lock));
+	return m_bytesOutstanding;
+}
+
+size_t FrameBufferPool::getBytesCached() const {
+	std::unique_ptr<imaqkit::IAutoCriticalSection> guard(imaqkit::createAutoCriticalSection(m_lock));
+	return m_bytesCached;
+}
@@ -0,0 +1,107 @@
+#include "../include/FramePairing.h"
+
+FramePairing::FramePairing(int streamCount, TIMESPAN tolerance)
+	:m_streamCount(streamCount < MAX_STREAMS ? streamCount : MAX_STREAMS),
+	m_tolerance(tolerance) {
+	reset();
+}
+
+void FramePairing::reset() {
+	for (int i = 0; i < MAX_STREAMS; i++) {
+		m_count[i] = 0;
+		m_latest[i] = -1;
+	}
+	m_matched = 0;
+	m_unmatched = 0;
+}
+
+int FramePairing::push(int stream, TIMESPAN time) {
+	int slot = (m_latest[stream] + 1) % HISTORY;
+
+	m_times[stream][slot] = time;
+	m_latest[stream] = slot;
+	if (m_count[stream] < HISTORY) {
+		m_count[stream]++;
+	}
+
+	return slot;
+}
+
+int FramePairing::find(int stream, TIMESPAN time) const {
+	int best = -1;
+	TIMESPAN bestDelta = m_tolerance;
+
+	for (int i = 0; i < m_count[stream]; i++) {
+		TIMESPAN delta = m_times[stream][i] - time;
+		if (delta < 0) {
+			delta = -delta;
+		}
+
+		if (delta <= bestDelta) {
+			best = i;
+			bestDelta = delta;
+		}
+	}
+
+	return best;
+}
+
+bool FramePairing::match(int referenceStream, int *slots) const {
+	if (m_latest[referenceStream] < 0) {
+		return false;
+	}
+
+	TIMESPAN time = m_times[referenceStream][m_latest[referenceStream]];
+
+	for (int i = 0; i < m_streamCount; i++) {
+		slots[i] = (i == referenceStream) ? m_latest[i] : find(i, time);
+		if (slots[i] < 0) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool FramePairing::matchLatest(int referenceStream, unsigned int latestStreams, int *slots) const {
+	if (!match(referenceStream, slots)) {
+		return false;
+	}
+
+	for (int i = 0; i < m_streamCount; i++) {
+		if ((latestStreams & (1u << i)) != 0 && slots[i] != m_latest[i]) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+TIMESPAN FramePairing::getTime(int stream, int slot) const {
+	return m_times[stream][slot];
+}
+
+TIMESPAN FramePairing::getLatestTime(int stream) const {
+	return m_latest[stream] < 0 ? 0 : m_times[stream][m_latest[stream]];
+}
+
+int FramePairing::getLatestSlot(int stream) const {
+	return m_latest[stream];
+}
+
+unsigned int FramePairing::getMatchedCount() const {
+	return m_matched;
+}
+
+unsigned int FramePairing::getUnmatchedCount() const {
+	return m_unmatched;
+}
+
+void FramePairing::countMatch(bool matched) {
+	if (matched) {
+		m_matched++;
+	}
+	else {
+		m_unmatched++;
+	}
+}
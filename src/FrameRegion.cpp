@@ -0,0 +1,29 @@
+#include "../include/FrameRegion.h"
+
+#include <cstring>
+
+void frameregion::copyRegion(const BYTE *source, int frameWidth, int bytesPerPixel, int top, int rows,
+	int originX, int originY, int width, int height, BYTE *data) {
+	size_t stride = static_cast<size_t>(frameWidth) * bytesPerPixel;
+	size_t rowSize = static_cast<size_t>(width) * bytesPerPixel;
+
+	int first = top > originY ? top : originY;
+	int last = top + rows < originY + height ? top + rows : originY + height;
+	if (first >= last) {
+		return;
+	}
+
+	const BYTE *src = source + (first - top) * stride + originX * bytesPerPixel;
+	BYTE *dst = data + (first - originY) * rowSize;
+
+	if (rowSize == stride) {
+		memcpy(dst, src, (last - first) * stride);
+		return;
+	}
+
+	for (int y = first; y < last; y++) {
+		memcpy(dst, src, rowSize);
+		src += stride;
+		dst += rowSize;
+	}
+}
@@ -0,0 +1,181 @@
+#include "../include/InfraredConversion.h"
+
+#include <emmintrin.h>
+
+namespace {
+	//Long exposure intensities over which the merge fades from the long to
+	//the short exposure
+	const float BLEND_START = 32768.0f;
+	const float BLEND_END = 60000.0f;
+
+	//Short exposure pixels darker than this are mostly noise
+	const float NOISE_FLOOR = 64.0f;
+
+	//Pixels needed before the ratio estimate is trusted
+	const int MIN_RATIO_PIXELS = 1024;
+
+	//Pixels summed in single precision before flushing into the totals
+	const int RATIO_CHUNK = 1024;
+
+	__m128 toFloat(__m128i words, bool high) {
+		__m128i zero = _mm_setzero_si128();
+		return _mm_cvtepi32_ps(high ? _mm_unpackhi_epi16(words, zero) : _mm_unpacklo_epi16(words, zero));
+	}
+
+	//Weight of the short exposure, 0 below the blend range and 1 above it
+	__m128 blendWeight(__m128 longValue) {
+		const __m128 start = _mm_set1_ps(BLEND_START);
+		const __m128 scale = _mm_set1_ps(1.0f / (BLEND_END - BLEND_START));
+		const __m128 one = _mm_set1_ps(1.0f);
+
+		__m128 weight = _mm_mul_ps(_mm_sub_ps(longValue, start), scale);
+		return _mm_min_ps(_mm_max_ps(weight, _mm_setzero_ps()), one);
+	}
+
+	float blendWeight(float longValue) {
+		float weight = (longValue - BLEND_START) / (BLEND_END - BLEND_START);
+		if (weight < 0) {
+			return 0;
+		}
+		return weight > 1 ? 1 : weight;
+	}
+
+	//Highlight scale of the 16-bit merge: merged values above BLEND_START
+	//are compressed so the brightest the short exposure can give lands on
+	//65535, while the long exposure below it is kept as is
+	float highlightScale(float ratio) {
+		float brightest = 65535.0f * (ratio > 1 ? ratio : 1);
+		return (65535.0f - BLEND_START) / (brightest - BLEND_START);
+	}
+
+	float horizontalSum(__m128 value) {
+		float lanes[4];
+		_mm_storeu_ps(lanes, value);
+		return lanes[0] + lanes[1] + lanes[2] + lanes[3];
+	}
+}
+
+float infraredconversion::exposureRatio(const UINT16 *shortExposure, const UINT16 *longExposure, int count, float previous) {
+	const __m128 floor = _mm_set1_ps(NOISE_FLOOR);
+	const __m128 start = _mm_set1_ps(BLEND_START);
+	const __m128 one = _mm_set1_ps(1.0f);
+
+	double shortTotal = 0;
+	double longTotal = 0;
+	double pixels = 0;
+	int i = 0;
+
+	while (i + 8 <= count) {
+		__m128 shortSum = _mm_setzero_ps();
+		__m128 longSum = _mm_setzero_ps();
+		__m128 pixelSum = _mm_setzero_ps();
+		int end = i + RATIO_CHUNK < count ? i + RATIO_CHUNK : count;
+
+		for (; i + 8 <= end; i += 8) {
+			__m128i shortWords = _mm_loadu_si128(reinterpret_cast<const __m128i*>(shortExposure + i));
+			__m128i longWords = _mm_loadu_si128(reinterpret_cast<const __m128i*>(longExposure + i));
+
+			for (int half = 0; half < 2; half++) {
+				__m128 s = toFloat(shortWords, half == 1);
+				__m128 l = toFloat(longWords, half == 1);
+
+				//Well exposed: above the noise in the short exposure and
+				//below the blend range in the long one
+				__m128 use = _mm_and_ps(_mm_cmpgt_ps(s, floor), _mm_cmplt_ps(l, start));
+
+				shortSum = _mm_add_ps(shortSum, _mm_and_ps(use, s));
+				longSum = _mm_add_ps(longSum, _mm_and_ps(use, l));
+				pixelSum = _mm_add_ps(pixelSum, _mm_and_ps(use, one));
+			}
+		}
+
+		shortTotal += horizontalSum(shortSum);
+		longTotal += horizontalSum(longSum);
+		pixels += horizontalSum(pixelSum);
+	}
+
+	for (; i < count; i++) {
+		if (shortExposure[i] > NOISE_FLOOR && longExposure[i] < BLEND_START) {
+			shortTotal += shortExposure[i];
+			longTotal += longExposure[i];
+			pixels++;
+		}
+	}
+
+	if (pixels < MIN_RATIO_PIXELS || shortTotal <= 0 || longTotal <= 0) {
+		return previous;
+	}
+	return static_cast<float>(longTotal / shortTotal);
+}
+
+void infraredconversion::mergeExposures(const UINT16 *shortExposure, const UINT16 *longExposure, int count,
+	float ratio, float *hdr) {
+
+	const __m128 ratioVector = _mm_set1_ps(ratio);
+	int i = 0;
+
+	for (; i + 8 <= count; i += 8) {
+		__m128i shortWords = _mm_loadu_si128(reinterpret_cast<const __m128i*>(shortExposure + i));
+		__m128i longWords = _mm_loadu_si128(reinterpret_cast<const __m128i*>(longExposure + i));
+
+		for (int half = 0; half < 2; half++) {
+			__m128 s = _mm_mul_ps(toFloat(shortWords, half == 1), ratioVector);
+			__m128 l = toFloat(longWords, half == 1);
+			__m128 weight = blendWeight(l);
+
+			_mm_storeu_ps(hdr + i + half * 4, _mm_add_ps(l, _mm_mul_ps(weight, _mm_sub_ps(s, l))));
+		}
+	}
+
+	for (; i < count; i++) {
+		float s = shortExposure[i] * ratio;
+		float l = longExposure[i];
+		hdr[i] = l + blendWeight(l) * (s - l);
+	}
+}
+
+void infraredconversion::mergeExposures(const UINT16 *shortExposure, const UINT16 *longExposure, int count,
+	float ratio, UINT16 *hdr) {
+
+	const __m128 ratioVector = _mm_set1_ps(ratio);
+	const __m128 knee = _mm_set1_ps(BLEND_START);
+	const __m128 compression = _mm_set1_ps(1 - highlightScale(ratio));
+	const __m128 limit = _mm_set1_ps(65535.0f);
+	//packs_epi32 saturates signed, so pack around zero and flip back
+	const __m128 bias = _mm_set1_ps(32768.0f);
+	const __m128i signBit = _mm_set1_epi16(static_cast<short>(0x8000));
+	int i = 0;
+
+	for (; i + 8 <= count; i += 8) {
+		__m128i shortWords = _mm_loadu_si128(reinterpret_cast<const __m128i*>(shortExposure + i));
+		__m128i longWords = _mm_loadu_si128(reinterpret_cast<const __m128i*>(longExposure + i));
+		__m128i values[2];
+
+		for (int half = 0; half < 2; half++) {
+			__m128 s = _mm_mul_ps(toFloat(shortWords, half == 1), ratioVector);
+			__m128 l = toFloat(longWords, half == 1);
+			__m128 weight = blendWeight(l);
+
+			__m128 merged = _mm_add_ps(l, _mm_mul_ps(weight, _mm_sub_ps(s, l)));
+			__m128 highlight = _mm_max_ps(_mm_sub_ps(merged, knee), _mm_setzero_ps());
+			merged = _mm_sub_ps(merged, _mm_mul_ps(highlight, compression));
+			merged = _mm_sub_ps(_mm_min_ps(merged, limit), bias);
+			values[half] = _mm_cvtps_epi32(merged);
+		}
+
+		__m128i packed = _mm_xor_si128(_mm_packs_epi32(values[0], values[1]), signBit);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(hdr + i), packed);
+	}
+
+	float scale = highlightScale(ratio);
+	for (; i < count; i++) {
+		float s = shortExposure[i] * ratio;
+		float l = longExposure[i];
+		float merged = l + blendWeight(l) * (s - l);
+		if (merged > BLEND_START) {
+			merged = BLEND_START + (merged - BLEND_START) * scale;
+		}
+
+		hdr[i] = merged > 65535.0f ? 65535 : static_cast<UINT16>(merged + 0.5f);
+	}
+}
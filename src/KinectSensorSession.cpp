@@ -0,0 +1,151 @@
+#include "../include/KinectSensorSession.h"
+
+#include <memory>
+
+imaqkit::ICriticalSection *KinectSensorSession::s_lock = nullptr;
+std::map<std::wstring, KinectSensorSession*> KinectSensorSession::s_sessions;
+
+void KinectSensorSession::initialize() {
+	if (s_lock == nullptr) {
+		s_lock = imaqkit::createCriticalSection();
+	}
+}
+
+void KinectSensorSession::uninitialize() {
+	if (s_lock == nullptr) {
+		return;
+	}
+
+	{
+		std::unique_ptr<imaqkit::IAutoCriticalSection> guard(imaqkit::createAutoCriticalSection(s_lock));
+
+		for (std::map<std::wstring, KinectSensorSession*>::iterator it = s_sessions.begin(); it != s_sessions.end(); ++it) {
+			delete it->second;
+		}
+		s_sessions.clear();
+	}
+
+	delete s_lock;
+	s_lock = nullptr;
+}
+
+KinectSensorSession *KinectSensorSession::acquire(IKinectSensor *sensor) {
+	WCHAR wid[50];
+	memset(wid, 0, sizeof(wid));
+
+	if (FAILED(sensor->get_UniqueKinectId(50, wid))) {
+		return nullptr;
+	}
+
+	initialize();
+	std::unique_ptr<imaqkit::IAutoCriticalSection> guard(imaqkit::createAutoCriticalSection(s_lock));
+
+	std::wstring id(wid);
+	KinectSensorSession *session;
+
+	std::map<std::wstring, KinectSensorSession*>::iterator it = s_sessions.find(id);
+	if (it != s_sessions.end()) {
+		session = it->second;
+	}
+	else {
+		session = new KinectSensorSession(sensor, id);
+		s_sessions[id] = session;
+	}
+
+	//A session kept warm may still have lost its sensor, so always re-check
+	if (!session->open()) {
+		return nullptr;
+	}
+
+	session->m_refCount++;
+	return session;
+}
+
+void KinectSensorSession::release(KinectSensorSession *session) {
+	if (session == nullptr || s_lock == nullptr) {
+		return;
+	}
+
+	std::unique_ptr<imaqkit::IAutoCriticalSection> guard(imaqkit::createAutoCriticalSection(s_lock));
+
+	if (session->m_refCount > 0) {
+		session->m_refCount--;
+	}
+}
+
+KinectSensorSession::KinectSensorSession(IKinectSensor *sensor, const std::wstring &id)
+	:m_sensor(sensor),
+	m_id(id),
+	m_refCount(0),
+	m_depthRays(nullptr),
+	m_depthRayCount(0) {}
+
+KinectSensorSession::~KinectSensorSession() {
+	close();
+
+	if (m_depthRays != nullptr) {
+		CoTaskMemFree(m_depthRays);
+	}
+}
+
+IKinectSensor *KinectSensorSession::getSensor() const {
+	return m_sensor;
+}
+
+const std::wstring &KinectSensorSession::getId() const {
+	return m_id;
+}
+
+int KinectSensorSession::getReferenceCount() const {
+	return m_refCount;
+}
+
+FrameBufferPool &KinectSensorSession::getBufferPool() {
+	return m_bufferPool;
+}
+
+SensorClock &KinectSensorSession::getClock() {
+	return m_clock;
+}
+
+HRESULT KinectSensorSession::getDepthRayTable(const PointF **table, unsigned int *count) {
+	std::unique_ptr<imaqkit::IAutoCriticalSection> guard(imaqkit::createAutoCriticalSection(s_lock));
+
+	if (m_depthRays == nullptr) {
+		ICoordinateMapper *mapper;
+		HRESULT hr = m_sensor->get_CoordinateMapper(&mapper);
+		if (FAILED(hr)) {
+			return hr;
+		}
+
+		hr = mapper->GetDepthFrameToCameraSpaceTable(&m_depthRayCount, &m_depthRays);
+		mapper->Release();
+		if (FAILED(hr)) {
+			m_depthRays = nullptr;
+			m_depthRayCount = 0;
+			return hr;
+		}
+	}
+
+	*table = m_depthRays;
+	*count = m_depthRayCount;
+	return S_OK;
+}
+
+bool KinectSensorSession::open() {
+	BOOLEAN open;
+
+	if (FAILED(m_sensor->get_IsOpen(&open))) {
+		return false;
+	}
+
+	return open || SUCCEEDED(m_sensor->Open());
+}
+
+void KinectSensorSession::close() {
+	BOOLEAN open;
+
+	if (SUCCEEDED(m_sensor->get_IsOpen(&open)) && open) {
+		m_sensor->Close();
+	}
+}
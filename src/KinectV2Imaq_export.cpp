@@ -3,14 +3,35 @@
 
 #include <comdef.h>
 
+#include "../include/BodyAdapter.h"
+#include "../include/BodyIndexAdapter.h"
 #include "../include/ColourAdapter.h"
 #include "../include/DepthAdapter.h"
 #include "../include/InfraredAdapter.h"
 #include "../include/LongExposureInfraredAdapter.h"
 #include "../include/KinectDeviceInfo.h"
+#include "../include/KinectDeviceProperties.h"
+#include "../include/KinectSensorSession.h"
+#include "../include/SynchronizedAdapter.h"
+
+//Device ids are allocated in blocks of DEVICE_COUNT per sensor
+enum KinectDevice {
+	COLOUR_DEVICE = 1,
+	DEPTH_DEVICE,
+	INFRARED_DEVICE,
+	LONG_EXPOSURE_INFRARED_DEVICE,
+	SYNCHRONIZED_DEVICE,
+	BODY_DEVICE,
+	BODY_INDEX_DEVICE,
+	DEVICE_COUNT = BODY_INDEX_DEVICE
+};
+
+static const int synchronizedSourceTypes = FrameSourceTypes::FrameSourceTypes_Color
+	| FrameSourceTypes::FrameSourceTypes_Depth
+	| FrameSourceTypes::FrameSourceTypes_Infrared;
 
 void initializeAdaptor(){
-
+	KinectSensorSession::initialize();
 }
 
 void addKinectDevicetoHW(imaqkit::IHardwareInfo *hwInfo, IKinectSensor *kinect, int sensorId);
@@ -57,7 +78,7 @@ void addKinectDevicetoHW(imaqkit::IHardwareInfo *hwInfo, IKinectSensor *kinect,
 	char * colourId = (char*)malloc(sizeof(char)* strlen(colourIdFormat) - 2 + strlen(id) + 2);
 	sprintf(colourId, colourIdFormat, id);
 	imaqkit::IDeviceInfo* colourInfo =
-		hwInfo->createDeviceInfo((sensorId-1)*4+1, colourId);
+		hwInfo->createDeviceInfo((sensorId - 1) * DEVICE_COUNT + COLOUR_DEVICE, colourId);
 
 	KinectDeviceInfo *colourKinectInfo = new KinectDeviceInfo();
 	colourKinectInfo->setDevice(kinect);
@@ -67,10 +88,12 @@ void addKinectDevicetoHW(imaqkit::IHardwareInfo *hwInfo, IKinectSensor *kinect,
 
 	free(colourId);
 
-	char *colorFormatNames[5] = { "RGB32_1920x1080", "YUV_UYVY_1920x1080", "BGR32_1920x1080", "BAYER_GRBG_1920x1080", "YUV_YUY2_1920x1080" };
+	char *colorFormatNames[13] = { "RGB32_1920x1080", "YUV_UYVY_1920x1080", "BGR32_1920x1080", "BAYER_GRBG_1920x1080", "YUV_YUY2_1920x1080",
+		"RGB24_960x540", "RGB24_480x270", "MONO16_DEPTH_1920x1080", "RGB24_1920x1080",
+		"RGB24_PLANAR_1920x1080", "RGB24_PLANAR_960x540", "RGB24_PLANAR_480x270", "RGB24_DEMOSAIC_1920x1080" };
 
-	imaqkit::IDeviceFormat *colourFormat[5];
-	for (int i = 0; i < 5; i++) {
+	imaqkit::IDeviceFormat *colourFormat[13];
+	for (int i = 0; i < 13; i++) {
 		colourFormat[i] = colourInfo->createDeviceFormat(i + 1, colorFormatNames[i]);
 		colourInfo->addDeviceFormat(colourFormat[i], i == 0);
 	}
@@ -82,7 +105,7 @@ void addKinectDevicetoHW(imaqkit::IHardwareInfo *hwInfo, IKinectSensor *kinect,
 	sprintf(depthId, depthIdFormat, id);
 
 	imaqkit::IDeviceInfo* depthInfo =
-		hwInfo->createDeviceInfo((sensorId - 1) * 4 + 2, depthId);
+		hwInfo->createDeviceInfo((sensorId - 1) * DEVICE_COUNT + DEPTH_DEVICE, depthId);
 
 	KinectDeviceInfo *depthKinectInfo = new KinectDeviceInfo();
 	depthKinectInfo->setDevice(kinect);
@@ -92,8 +115,15 @@ void addKinectDevicetoHW(imaqkit::IHardwareInfo *hwInfo, IKinectSensor *kinect,
 
 	free(depthId);
 
-	imaqkit::IDeviceFormat* depthFormat = depthInfo->createDeviceFormat(1, "MONO12_512x423");
-	depthInfo->addDeviceFormat(depthFormat);
+	//Raw millimetres, metres, a clipped visualisation and the camera space
+	//point cloud as X, Y and Z planes stacked vertically
+	char *depthFormatNames[4] = { "MONO12_512x424", "FLOAT_512x424", "MONO8_512x424", "XYZ_FLOAT_512x1272" };
+
+	imaqkit::IDeviceFormat *depthFormat[4];
+	for (int i = 0; i < 4; i++) {
+		depthFormat[i] = depthInfo->createDeviceFormat(i + 1, depthFormatNames[i]);
+		depthInfo->addDeviceFormat(depthFormat[i], i == 0);
+	}
 
 	hwInfo->addDevice(depthInfo);
 
@@ -102,7 +132,7 @@ void addKinectDevicetoHW(imaqkit::IHardwareInfo *hwInfo, IKinectSensor *kinect,
 	sprintf(infraredId, infraredIdFormat, id);
 
 	imaqkit::IDeviceInfo* infraredInfo =
-		hwInfo->createDeviceInfo((sensorId - 1) * 4 + 3, infraredId);
+		hwInfo->createDeviceInfo((sensorId - 1) * DEVICE_COUNT + INFRARED_DEVICE, infraredId);
 
 	KinectDeviceInfo *infraredKinectInfo = new KinectDeviceInfo();
 	infraredKinectInfo->setDevice(kinect);
@@ -122,7 +152,7 @@ void addKinectDevicetoHW(imaqkit::IHardwareInfo *hwInfo, IKinectSensor *kinect,
 	sprintf(leInfraredId, leInfraredIdFormat, id);
 
 	imaqkit::IDeviceInfo* leInfraredInfo =
-		hwInfo->createDeviceInfo((sensorId - 1) * 4 + 4, leInfraredId);
+		hwInfo->createDeviceInfo((sensorId - 1) * DEVICE_COUNT + LONG_EXPOSURE_INFRARED_DEVICE, leInfraredId);
 
 	KinectDeviceInfo *leInfraredKinectInfo = new KinectDeviceInfo();
 	leInfraredKinectInfo->setDevice(kinect);
@@ -136,6 +166,86 @@ void addKinectDevicetoHW(imaqkit::IHardwareInfo *hwInfo, IKinectSensor *kinect,
 	leInfraredInfo->addDeviceFormat(leInfraredFormat);
 
 	hwInfo->addDevice(leInfraredInfo);
+
+	const char* synchronizedIdFormat = "Kinect v2 (%s) Synchronized";
+	char * synchronizedId = (char*)malloc(sizeof(char)* strlen(synchronizedIdFormat) - 2 + strlen(id) + 2);
+	sprintf(synchronizedId, synchronizedIdFormat, id);
+
+	imaqkit::IDeviceInfo* synchronizedInfo =
+		hwInfo->createDeviceInfo((sensorId - 1) * DEVICE_COUNT + SYNCHRONIZED_DEVICE, synchronizedId);
+
+	KinectDeviceInfo *synchronizedKinectInfo = new KinectDeviceInfo();
+	synchronizedKinectInfo->setDevice(kinect);
+	synchronizedKinectInfo->setFrameSourceType(synchronizedSourceTypes);
+
+	synchronizedInfo->setAdaptorData(synchronizedKinectInfo);
+
+	free(synchronizedId);
+
+	//Depth rows followed by infrared rows of the matched tuple; colour only
+	//validates the match
+	imaqkit::IDeviceFormat* synchronizedFormat = synchronizedInfo->createDeviceFormat(1, "MONO16_512x848");
+	synchronizedInfo->addDeviceFormat(synchronizedFormat, true);
+
+	//Colour of the matched tuple registered to the depth pixels
+	imaqkit::IDeviceFormat* registeredFormat = synchronizedInfo->createDeviceFormat(2, "RGB24_REGISTERED_512x424");
+	synchronizedInfo->addDeviceFormat(registeredFormat);
+
+	//Short and long exposure infrared fused into one HDR image
+	imaqkit::IDeviceFormat* hdrFloatFormat = synchronizedInfo->createDeviceFormat(3, "FLOAT_HDR_512x424");
+	synchronizedInfo->addDeviceFormat(hdrFloatFormat);
+
+	imaqkit::IDeviceFormat* hdrMono16Format = synchronizedInfo->createDeviceFormat(4, "MONO16_HDR_512x424");
+	synchronizedInfo->addDeviceFormat(hdrMono16Format);
+
+	hwInfo->addDevice(synchronizedInfo);
+
+	const char* bodyIdFormat = "Kinect v2 (%s) Body";
+	char * bodyId = (char*)malloc(sizeof(char)* strlen(bodyIdFormat) - 2 + strlen(id) + 2);
+	sprintf(bodyId, bodyIdFormat, id);
+
+	imaqkit::IDeviceInfo* bodyInfo =
+		hwInfo->createDeviceInfo((sensorId - 1) * DEVICE_COUNT + BODY_DEVICE, bodyId);
+
+	KinectDeviceInfo *bodyKinectInfo = new KinectDeviceInfo();
+	bodyKinectInfo->setDevice(kinect);
+	bodyKinectInfo->setFrameSourceType(FrameSourceTypes::FrameSourceTypes_Body);
+
+	bodyInfo->setAdaptorData(bodyKinectInfo);
+
+	free(bodyId);
+
+	//One placeholder pixel per body; the skeletons travel as metadata
+	imaqkit::IDeviceFormat* bodyFormat = bodyInfo->createDeviceFormat(1, "MONO8_6x1");
+	bodyInfo->addDeviceFormat(bodyFormat, true);
+
+	hwInfo->addDevice(bodyInfo);
+
+	const char* bodyIndexIdFormat = "Kinect v2 (%s) Body Index";
+	char * bodyIndexId = (char*)malloc(sizeof(char)* strlen(bodyIndexIdFormat) - 2 + strlen(id) + 2);
+	sprintf(bodyIndexId, bodyIndexIdFormat, id);
+
+	imaqkit::IDeviceInfo* bodyIndexInfo =
+		hwInfo->createDeviceInfo((sensorId - 1) * DEVICE_COUNT + BODY_INDEX_DEVICE, bodyIndexId);
+
+	KinectDeviceInfo *bodyIndexKinectInfo = new KinectDeviceInfo();
+	bodyIndexKinectInfo->setDevice(kinect);
+	bodyIndexKinectInfo->setFrameSourceType(FrameSourceTypes::FrameSourceTypes_BodyIndex);
+
+	bodyIndexInfo->setAdaptorData(bodyIndexKinectInfo);
+
+	free(bodyIndexId);
+
+	//Body indices, and depth with the pixels outside any body cleared
+	char *bodyIndexFormatNames[2] = { "MONO8_512x424", "MONO12_MASKED_512x424" };
+
+	imaqkit::IDeviceFormat *bodyIndexFormat[2];
+	for (int i = 0; i < 2; i++) {
+		bodyIndexFormat[i] = bodyIndexInfo->createDeviceFormat(i + 1, bodyIndexFormatNames[i]);
+		bodyIndexInfo->addDeviceFormat(bodyIndexFormat[i], i == 0);
+	}
+
+	hwInfo->addDevice(bodyIndexInfo);
 }
 
 void getDeviceAttributes(const imaqkit::IDeviceInfo* deviceInfo,
@@ -147,6 +257,79 @@ void getDeviceAttributes(const imaqkit::IDeviceInfo* deviceInfo,
 	// Create a video source
 	sourceContainer->addAdaptorSource("KinectV2Source", 1);
 
+	void *hProp;
+
+	hProp = devicePropFact->createIntProperty(kinectprops::FRAME_QUEUE_DEPTH, 2,
+		kinectprops::FRAME_QUEUE_DEPTH_MAX, kinectprops::FRAME_QUEUE_DEPTH_DEFAULT);
+	devicePropFact->setPropReadOnly(hProp, imaqkit::propreadonly::WHILE_RUNNING);
+	devicePropFact->addProperty(hProp);
+
+	hProp = devicePropFact->createEnumProperty(kinectprops::FRAME_DROP_POLICY,
+		kinectprops::DROP_OLDEST_STR, kinectprops::DROP_OLDEST_ID);
+	devicePropFact->addEnumValue(hProp, kinectprops::DROP_NEWEST_STR, kinectprops::DROP_NEWEST_ID);
+	devicePropFact->addEnumValue(hProp, kinectprops::BLOCK_STR, kinectprops::BLOCK_ID);
+	devicePropFact->setPropReadOnly(hProp, imaqkit::propreadonly::WHILE_RUNNING);
+	devicePropFact->addProperty(hProp);
+
+	const char *poolProps[] = { kinectprops::BUFFER_POOL_HITS, kinectprops::BUFFER_POOL_MISSES,
+		kinectprops::BUFFER_POOL_BYTES_OUTSTANDING };
+	for (int i = 0; i < 3; i++) {
+		hProp = devicePropFact->createIntProperty(poolProps[i], 0);
+		devicePropFact->setPropReadOnly(hProp, imaqkit::propreadonly::ALWAYS);
+		devicePropFact->addProperty(hProp);
+	}
+
+	KinectDeviceInfo *info = dynamic_cast<KinectDeviceInfo*>(deviceInfo->getAdaptorData());
+
+	if (info != nullptr && info->getFrameSourceType() == FrameSourceTypes::FrameSourceTypes_Color) {
+		hProp = devicePropFact->createEnumProperty(kinectprops::COLOUR_MATRIX,
+			kinectprops::BT601_STR, kinectprops::BT601_ID);
+		devicePropFact->addEnumValue(hProp, kinectprops::BT709_STR, kinectprops::BT709_ID);
+		devicePropFact->setPropReadOnly(hProp, imaqkit::propreadonly::WHILE_RUNNING);
+		devicePropFact->addProperty(hProp);
+
+		hProp = devicePropFact->createEnumProperty(kinectprops::DEMOSAIC_METHOD,
+			kinectprops::BILINEAR_STR, kinectprops::BILINEAR_ID);
+		devicePropFact->addEnumValue(hProp, kinectprops::EDGE_AWARE_STR, kinectprops::EDGE_AWARE_ID);
+		devicePropFact->setPropReadOnly(hProp, imaqkit::propreadonly::WHILE_RUNNING);
+		devicePropFact->addProperty(hProp);
+
+		hProp = devicePropFact->createIntProperty(kinectprops::WORKER_THREADS, 0,
+			kinectprops::WORKER_THREADS_MAX, 0);
+		devicePropFact->setPropReadOnly(hProp, imaqkit::propreadonly::WHILE_RUNNING);
+		devicePropFact->addProperty(hProp);
+
+		hProp = devicePropFact->createDoubleProperty(kinectprops::WORKER_AFFINITY, 0,
+			kinectprops::WORKER_AFFINITY_MAX, 0);
+		devicePropFact->setPropReadOnly(hProp, imaqkit::propreadonly::WHILE_RUNNING);
+		devicePropFact->addProperty(hProp);
+	}
+
+	if (info != nullptr && info->getFrameSourceType() == FrameSourceTypes::FrameSourceTypes_Depth) {
+		hProp = devicePropFact->createIntProperty(kinectprops::DEPTH_CLIP_MINIMUM, 0,
+			kinectprops::DEPTH_CLIP_LIMIT, kinectprops::DEPTH_CLIP_MINIMUM_DEFAULT);
+		devicePropFact->setPropReadOnly(hProp, imaqkit::propreadonly::WHILE_RUNNING);
+		devicePropFact->addProperty(hProp);
+
+		hProp = devicePropFact->createIntProperty(kinectprops::DEPTH_CLIP_MAXIMUM, 0,
+			kinectprops::DEPTH_CLIP_LIMIT, kinectprops::DEPTH_CLIP_MAXIMUM_DEFAULT);
+		devicePropFact->setPropReadOnly(hProp, imaqkit::propreadonly::WHILE_RUNNING);
+		devicePropFact->addProperty(hProp);
+
+		hProp = devicePropFact->createEnumProperty(kinectprops::TEMPORAL_FILTER,
+			kinectprops::NONE_STR, kinectprops::NONE_ID);
+		devicePropFact->addEnumValue(hProp, kinectprops::AVERAGE_STR, kinectprops::AVERAGE_ID);
+		devicePropFact->addEnumValue(hProp, kinectprops::MEDIAN_STR, kinectprops::MEDIAN_ID);
+		devicePropFact->addEnumValue(hProp, kinectprops::HOLD_INVALID_STR, kinectprops::HOLD_INVALID_ID);
+		devicePropFact->setPropReadOnly(hProp, imaqkit::propreadonly::WHILE_RUNNING);
+		devicePropFact->addProperty(hProp);
+
+		hProp = devicePropFact->createIntProperty(kinectprops::TEMPORAL_WINDOW, kinectprops::TEMPORAL_WINDOW_MINIMUM,
+			kinectprops::TEMPORAL_WINDOW_MAXIMUM, kinectprops::TEMPORAL_WINDOW_DEFAULT);
+		devicePropFact->setPropReadOnly(hProp, imaqkit::propreadonly::WHILE_RUNNING);
+		devicePropFact->addProperty(hProp);
+	}
+
 }
 
 imaqkit::IAdaptor* createInstance(imaqkit::IEngine* engine, const
@@ -178,6 +361,18 @@ imaqkit::IAdaptor* createInstance(imaqkit::IEngine* engine, const
 			ca = new LongExposureInfraredAdapter(engine, info, formatName);
 			break;
 
+		case FrameSourceTypes::FrameSourceTypes_BodyIndex:
+			ca = new BodyIndexAdapter(engine, info, formatName);
+			break;
+
+		case FrameSourceTypes::FrameSourceTypes_Body:
+			ca = new BodyAdapter(engine, info, formatName);
+			break;
+
+		case synchronizedSourceTypes:
+			ca = new SynchronizedAdapter(engine, info, formatName);
+			break;
+
 		default:
 			ca = nullptr;
 			break;
@@ -187,5 +382,5 @@ imaqkit::IAdaptor* createInstance(imaqkit::IEngine* engine, const
 }
 
 void uninitializeAdaptor(){
-
+	KinectSensorSession::uninitialize();
 }
\ No newline at end of file
@@ -0,0 +1,162 @@
+#include "../include/RowBandPool.h"
+
+//Processors set in an affinity mask, lowest first
+static std::vector<int> maskProcessors(DWORD_PTR mask) {
+	std::vector<int> processors;
+
+	for (int i = 0; i < static_cast<int>(sizeof(DWORD_PTR) * 8); i++) {
+		if ((mask >> i) & 1) {
+			processors.push_back(i);
+		}
+	}
+	return processors;
+}
+
+RowBandPool::RowBandPool(int threadCount, DWORD_PTR affinityMask)
+	:m_threadCount(threadCount),
+	m_affinityMask(affinityMask),
+	m_callerMask(0),
+	m_task(nullptr),
+	m_rows(0),
+	m_exit(false) {
+
+	std::vector<int> processors = maskProcessors(m_affinityMask);
+
+	if (m_threadCount <= 0 && !processors.empty()) {
+		m_threadCount = static_cast<int>(processors.size());
+	}
+	if (m_threadCount <= 0) {
+		SYSTEM_INFO info;
+		GetSystemInfo(&info);
+		m_threadCount = info.dwNumberOfProcessors;
+	}
+
+	//WaitForMultipleObjects waits on at most MAXIMUM_WAIT_OBJECTS handles
+	if (m_threadCount > MAXIMUM_WAIT_OBJECTS) {
+		m_threadCount = MAXIMUM_WAIT_OBJECTS;
+	}
+
+	if (!processors.empty()) {
+		m_callerMask = static_cast<DWORD_PTR>(1) << processors[0];
+	}
+
+	//The calling thread takes band 0. Workers hold pointers into m_workers,
+	//so it never reallocates.
+	m_workers.reserve(m_threadCount - 1);
+	for (int index = 1; index < m_threadCount; index++) {
+		HANDLE startEvent = CreateEvent(NULL, FALSE, FALSE, NULL);
+		HANDLE doneEvent = CreateEvent(NULL, FALSE, FALSE, NULL);
+
+		HANDLE thread = NULL;
+		if (startEvent != NULL && doneEvent != NULL) {
+			m_workers.push_back(Worker());
+			Worker &worker = m_workers.back();
+			worker.pool = this;
+			worker.index = index;
+			worker.startEvent = startEvent;
+			worker.doneEvent = doneEvent;
+
+			thread = CreateThread(NULL, 0, workerThread, &worker, 0, NULL);
+			worker.thread = thread;
+		}
+
+		//Carry on with the workers that did start, in fewer bands
+		if (thread == NULL) {
+			if (startEvent != NULL && doneEvent != NULL) {
+				m_workers.pop_back();
+			}
+			if (startEvent != NULL) {
+				CloseHandle(startEvent);
+			}
+			if (doneEvent != NULL) {
+				CloseHandle(doneEvent);
+			}
+			break;
+		}
+
+		if (!processors.empty()) {
+			int processor = processors[index % processors.size()];
+			SetThreadAffinityMask(thread, static_cast<DWORD_PTR>(1) << processor);
+		}
+
+		m_doneEvents.push_back(doneEvent);
+	}
+	m_threadCount = static_cast<int>(m_workers.size()) + 1;
+}
+
+RowBandPool::~RowBandPool() {
+	m_exit = true;
+
+	for (size_t i = 0; i < m_workers.size(); i++) {
+		SetEvent(m_workers[i].startEvent);
+	}
+
+	for (size_t i = 0; i < m_workers.size(); i++) {
+		Worker &worker = m_workers[i];
+
+		WaitForSingleObject(worker.thread, INFINITE);
+		CloseHandle(worker.thread);
+		CloseHandle(worker.startEvent);
+		CloseHandle(worker.doneEvent);
+	}
+}
+
+int RowBandPool::getThreadCount() const {
+	return m_threadCount;
+}
+
+DWORD_PTR RowBandPool::getAffinityMask() const {
+	return m_affinityMask;
+}
+
+void RowBandPool::run(Task &task, int rows) {
+	m_task = &task;
+	m_rows = rows;
+
+	for (size_t i = 0; i < m_workers.size(); i++) {
+		SetEvent(m_workers[i].startEvent);
+	}
+
+	DWORD_PTR callerAffinity = 0;
+	if (m_callerMask != 0) {
+		callerAffinity = SetThreadAffinityMask(GetCurrentThread(), m_callerMask);
+	}
+
+	runBand(0);
+
+	if (callerAffinity != 0) {
+		SetThreadAffinityMask(GetCurrentThread(), callerAffinity);
+	}
+
+	if (!m_doneEvents.empty()) {
+		WaitForMultipleObjects(static_cast<DWORD>(m_doneEvents.size()), &m_doneEvents[0], TRUE, INFINITE);
+	}
+
+	m_task = nullptr;
+}
+
+void RowBandPool::runBand(int index) {
+	int first = m_rows * index / m_threadCount;
+	int last = m_rows * (index + 1) / m_threadCount;
+
+	if (first < last) {
+		m_task->run(first, last);
+	}
+}
+
+DWORD WINAPI RowBandPool::workerThread(void* param) {
+	Worker *worker = reinterpret_cast<Worker*>(param);
+	RowBandPool *pool = worker->pool;
+
+	for (;;) {
+		WaitForSingleObject(worker->startEvent, INFINITE);
+		if (pool->m_exit) {
+			break;
+		}
+
+		pool->runBand(worker->index);
+		SetEvent(worker->doneEvent);
+	}
+
+	return 0;
+}
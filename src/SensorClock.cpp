@@ -0,0 +1,198 @@
+#include "../include/SensorClock.h"
+
+#include <cmath>
+
+const double SensorClock::DEFAULT_FORGETTING = 0.999;
+const double SensorClock::MAX_DRIFT = 0.001;
+
+//RelativeTime counts 100 ns ticks
+static const double ticksPerSecond = 10000000.0;
+
+//The slope is only trusted once the samples span this many seconds
+static const double minimumSpan = 1.0;
+
+//A larger jump means the sensor was reopened and its clock restarted
+static const double maximumResidual = 1.0;
+
+//Stream latencies are averaged over all their samples until there are this
+//many, then over about this many of the latest
+static const double latencySamples = 100.0;
+
+namespace {
+	class SectionGuard {
+	public:
+		explicit SectionGuard(CRITICAL_SECTION &section) :m_section(section) {
+			EnterCriticalSection(&m_section);
+		}
+		~SectionGuard() {
+			LeaveCriticalSection(&m_section);
+		}
+
+	private:
+		CRITICAL_SECTION &m_section;
+
+		SectionGuard(const SectionGuard&);
+		SectionGuard &operator=(const SectionGuard&);
+	};
+}
+
+SensorClock::SensorClock(double forgetting)
+	:m_forgetting(forgetting) {
+	InitializeCriticalSection(&m_lock);
+	reset();
+}
+
+SensorClock::~SensorClock() {
+	DeleteCriticalSection(&m_lock);
+}
+
+void SensorClock::reset() {
+	SectionGuard guard(m_lock);
+	clear();
+}
+
+void SensorClock::clear() {
+	m_sensorOrigin = 0;
+	m_hostOrigin = 0;
+	m_streamCount = 0;
+
+	m_weight = 0;
+	m_sumX = 0;
+	m_sumY = 0;
+	m_sumXX = 0;
+	m_sumXY = 0;
+
+	m_slope = 1;
+	m_intercept = 0;
+	m_residual = 0;
+	m_samples = 0;
+}
+
+double SensorClock::toSeconds(TIMESPAN sensorTime) const {
+	return static_cast<double>(sensorTime - m_sensorOrigin) / ticksPerSecond;
+}
+
+double SensorClock::mapLocked(double x) const {
+	return m_hostOrigin + m_intercept + m_slope * x;
+}
+
+SensorClock::Stream *SensorClock::findStream(int key, bool add) {
+	for (int i = 0; i < m_streamCount; i++) {
+		if (m_streams[i].key == key) {
+			return &m_streams[i];
+		}
+	}
+	if (!add || m_streamCount == MAX_STREAMS) {
+		return nullptr;
+	}
+
+	Stream &stream = m_streams[m_streamCount++];
+	stream.key = key;
+	stream.latency = 0;
+	stream.samples = 0;
+	return &stream;
+}
+
+double SensorClock::update(int streamKey, TIMESPAN sensorTime, double hostTime) {
+	SectionGuard guard(m_lock);
+
+	Stream *stream = findStream(streamKey, true);
+
+	if (m_samples > 0) {
+		double error = hostTime - mapLocked(toSeconds(sensorTime));
+
+		//A stream's first sample only measures its latency
+		if (stream != nullptr && stream->samples == 0) {
+			error = 0;
+		}
+		else if (stream != nullptr) {
+			error -= stream->latency;
+		}
+
+		//Only a jump of the whole mapping restarts it; streams arriving out
+		//of order with each other are expected
+		if (fabs(error) > maximumResidual) {
+			clear();
+			stream = findStream(streamKey, true);
+		}
+		else {
+			m_residual = m_forgetting * m_residual + (1 - m_forgetting) * error * error;
+		}
+	}
+
+	if (m_samples == 0) {
+		m_sensorOrigin = sensorTime;
+		m_hostOrigin = hostTime;
+	}
+	m_samples++;
+
+	double x = toSeconds(sensorTime);
+
+	//The reference stream, the first one, keeps a latency of zero
+	if (stream != nullptr) {
+		stream->samples++;
+
+		if (stream != &m_streams[0]) {
+			double rate = 1.0 / (stream->samples < latencySamples ? stream->samples : latencySamples);
+			stream->latency += rate * (hostTime - mapLocked(x) - stream->latency);
+		}
+	}
+
+	double y = hostTime - m_hostOrigin - (stream != nullptr ? stream->latency : 0);
+
+	m_weight = m_forgetting * m_weight + 1;
+	m_sumX = m_forgetting * m_sumX + x;
+	m_sumY = m_forgetting * m_sumY + y;
+	m_sumXX = m_forgetting * m_sumXX + x * x;
+	m_sumXY = m_forgetting * m_sumXY + x * y;
+
+	double meanX = m_sumX / m_weight;
+	double meanY = m_sumY / m_weight;
+	double varX = m_sumXX / m_weight - meanX * meanX;
+
+	if (varX > minimumSpan * minimumSpan / 12) {
+		double slope = (m_sumXY / m_weight - meanX * meanY) / varX;
+
+		if (slope < 1 - MAX_DRIFT) {
+			slope = 1 - MAX_DRIFT;
+		}
+		else if (slope > 1 + MAX_DRIFT) {
+			slope = 1 + MAX_DRIFT;
+		}
+		m_slope = slope;
+	}
+	m_intercept = meanY - m_slope * meanX;
+
+	return mapLocked(x);
+}
+
+double SensorClock::map(TIMESPAN sensorTime) const {
+	SectionGuard guard(m_lock);
+	return mapLocked(toSeconds(sensorTime));
+}
+
+double SensorClock::getDrift() const {
+	SectionGuard guard(m_lock);
+	return m_slope - 1;
+}
+
+double SensorClock::getJitter() const {
+	SectionGuard guard(m_lock);
+	return sqrt(m_residual);
+}
+
+double SensorClock::getLatency(int streamKey) const {
+	SectionGuard guard(m_lock);
+
+	for (int i = 0; i < m_streamCount; i++) {
+		if (m_streams[i].key == streamKey) {
+			return m_streams[i].latency;
+		}
+	}
+	return 0;
+}
+
+unsigned int SensorClock::getSampleCount() const {
+	SectionGuard guard(m_lock);
+	return m_samples;
+}
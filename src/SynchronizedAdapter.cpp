@@ -0,0 +1,401 @@
+#include "../include/SynchronizedAdapter.h"
+
+#include "../include/ColourConversion.h"
+#include "../include/InfraredConversion.h"
+
+static const int depthWidth = 512;
+static const int depthHeight = 424;
+static const int depthPixels = depthWidth * depthHeight;
+static const int colourWidth = 1920;
+static const int colourHeight = 1080;
+
+SynchronizedAdapter::SynchronizedAdapter(imaqkit::IEngine* engine,
+	const KinectDeviceInfo *deviceInfo,
+	const char* formatName) 
+	:KinectAdapter(engine, deviceInfo),
+	m_pairing(STREAM_COUNT),
+	m_exposurePairing(EXPOSURE_COUNT),
+	m_exposureRatio(1.0f),
+	m_output(STACKED_OUTPUT),
+	m_mapper(nullptr),
+	m_mappedDepthTime(0),
+	m_hasMapping(false) {
+
+	if (strcmp(formatName, "RGB24_REGISTERED_512x424") == 0) {
+		m_output = REGISTERED_OUTPUT;
+	}
+	else if (strcmp(formatName, "FLOAT_HDR_512x424") == 0) {
+		m_output = HDR_FLOAT_OUTPUT;
+	}
+	else if (strcmp(formatName, "MONO16_HDR_512x424") == 0) {
+		m_output = HDR_MONO16_OUTPUT;
+	}
+
+	if (m_output == REGISTERED_OUTPUT) {
+		m_colourPoints.resize(depthPixels);
+	}
+}
+
+SynchronizedAdapter::~SynchronizedAdapter() {
+	stopAndJoin();
+
+	if (m_mapper != nullptr) {
+		m_mapper->Release();
+	}
+}
+
+const char* SynchronizedAdapter::getDriverDescription() const {
+	return "KinectV2Synchronized_Driver";
+}
+
+unsigned int SynchronizedAdapter::queryFrameSize() {
+	switch (m_output) {
+	case REGISTERED_OUTPUT:
+		return depthPixels * 3;
+	case HDR_FLOAT_OUTPUT:
+		return depthPixels * sizeof(float);
+	case HDR_MONO16_OUTPUT:
+		return depthPixels * sizeof(UINT16);
+	default:
+		return depthPixels * 2 * sizeof(UINT16);
+	}
+}
+
+HRESULT SynchronizedAdapter::openReader(IKinectSensor *source, IMultiSourceFrameReader **reader) {
+	if (isHdr()) {
+		return source->OpenMultiSourceFrameReader(FrameSourceTypes::FrameSourceTypes_Infrared
+			| FrameSourceTypes::FrameSourceTypes_LongExposureInfrared, reader);
+	}
+	return KinectAdapter::openReader(source, reader);
+}
+
+bool SynchronizedAdapter::isHdr() const {
+	return m_output == HDR_FLOAT_OUTPUT || m_output == HDR_MONO16_OUTPUT;
+}
+
+bool SynchronizedAdapter::startCapture() {
+	m_pairing.reset();
+	m_exposurePairing.reset();
+	m_exposureRatio = 1.0f;
+
+	if (m_output == REGISTERED_OUTPUT && m_mapper == nullptr) {
+		if (FAILED(getSensor()->get_CoordinateMapper(&m_mapper))) {
+			imaqkit::adaptorError(this, "SynchronizedAdapter:startCapture", "Unable to get coordinate mapper from kinect device.");
+			m_mapper = nullptr;
+			return false;
+		}
+	}
+
+	//Forces a mapping on the first frame
+	m_hasMapping = false;
+
+	return KinectAdapter::startCapture();
+}
+
+HRESULT SynchronizedAdapter::copyFrameData(IMultiSourceFrame *frame, BYTE *data, unsigned int size) {
+	if (m_output == REGISTERED_OUTPUT) {
+		return copyRegisteredFrame(frame, data);
+	}
+	if (isHdr()) {
+		return copyHdrFrame(frame, data);
+	}
+
+	BYTE *buffer;
+	unsigned int capacity;
+	TIMESPAN time;
+
+	IDepthFrameReference *depthRef;
+	if (FAILED(frame->get_DepthFrameReference(&depthRef))) {
+		return E_FAIL;
+	}
+
+	IDepthFrame *depthFrame;
+	HRESULT hr = depthRef->AcquireFrame(&depthFrame);
+	depthRef->Release();
+	if (FAILED(hr)) {
+		return hr;
+	}
+
+	depthFrame->get_RelativeTime(&time);
+	hr = KinectSourceTraits<IDepthFrameSource>::accessFrameData(depthFrame, &buffer, &capacity);
+	if (SUCCEEDED(hr)) {
+		copyRegion(buffer, 0, depthHeight, data);
+	}
+	depthFrame->Release();
+	if (FAILED(hr)) {
+		return hr;
+	}
+	m_pairing.push(DEPTH_STREAM, time);
+
+	//Without the infrared rows the lower half of the frame is never written
+	bool infraredCopied = false;
+	IInfraredFrameReference *infraredRef;
+	if (SUCCEEDED(frame->get_InfraredFrameReference(&infraredRef))) {
+		IInfraredFrame *infraredFrame;
+		if (SUCCEEDED(infraredRef->AcquireFrame(&infraredFrame))) {
+			infraredFrame->get_RelativeTime(&time);
+			if (SUCCEEDED(KinectSourceTraits<IInfraredFrameSource>::accessFrameData(infraredFrame, &buffer, &capacity))) {
+				copyRegion(buffer, depthHeight, depthHeight, data);
+				m_pairing.push(INFRARED_STREAM, time);
+				infraredCopied = true;
+			}
+			infraredFrame->Release();
+		}
+		infraredRef->Release();
+	}
+
+	//Only the colour timestamp is needed to validate the tuple
+	IColorFrameReference *colourRef;
+	if (SUCCEEDED(frame->get_ColorFrameReference(&colourRef))) {
+		if (SUCCEEDED(colourRef->get_RelativeTime(&time)) && time != m_pairing.getLatestTime(COLOUR_STREAM)) {
+			m_pairing.push(COLOUR_STREAM, time);
+		}
+		colourRef->Release();
+	}
+
+	//The infrared rows come from the frame in hand, so an older match from
+	//the history would deliver rows of a different frame
+	bool matched = infraredCopied && m_pairing.matchLatest(DEPTH_STREAM, 1u << INFRARED_STREAM, m_slots);
+	m_pairing.countMatch(matched);
+
+	return matched ? S_OK : E_PENDING;
+}
+
+//Samples the matched colour frame at each depth pixel. The depth to colour
+//mapping only changes with the depth, so it is reused for as long as the
+//multi-source frames carry the depth frame it was computed for.
+HRESULT SynchronizedAdapter::copyRegisteredFrame(IMultiSourceFrame *frame, BYTE *data) {
+	TIMESPAN time;
+
+	IDepthFrameReference *depthRef;
+	if (FAILED(frame->get_DepthFrameReference(&depthRef))) {
+		return E_FAIL;
+	}
+
+	IDepthFrame *depthFrame;
+	HRESULT hr = depthRef->AcquireFrame(&depthFrame);
+	depthRef->Release();
+	if (FAILED(hr)) {
+		return hr;
+	}
+
+	IColorFrameReference *colourRef;
+	IColorFrame *colourFrame = nullptr;
+	if (SUCCEEDED(frame->get_ColorFrameReference(&colourRef))) {
+		if (FAILED(colourRef->AcquireFrame(&colourFrame))) {
+			colourFrame = nullptr;
+		}
+		colourRef->Release();
+	}
+
+	UINT depthCapacity, colourCapacity;
+	UINT16 *depth;
+	BYTE *colour;
+	ColorImageFormat rawFormat;
+
+	if (colourFrame == nullptr
+		|| FAILED(depthFrame->AccessUnderlyingBuffer(&depthCapacity, &depth))
+		|| FAILED(colourFrame->get_RawColorImageFormat(&rawFormat))
+		|| rawFormat != ColorImageFormat::ColorImageFormat_Yuy2
+		|| FAILED(colourFrame->AccessRawUnderlyingBuffer(&colourCapacity, &colour))
+		|| depthCapacity < depthPixels
+		|| colourCapacity < colourWidth * colourHeight * 2) {
+
+		if (colourFrame != nullptr) {
+			colourFrame->Release();
+		}
+		depthFrame->Release();
+		return E_PENDING;
+	}
+
+	TIMESPAN depthTime;
+	depthFrame->get_RelativeTime(&depthTime);
+	m_pairing.push(DEPTH_STREAM, depthTime);
+
+	colourFrame->get_RelativeTime(&time);
+	if (time != m_pairing.getLatestTime(COLOUR_STREAM)) {
+		m_pairing.push(COLOUR_STREAM, time);
+	}
+
+	//Only the infrared timestamp is needed to validate the tuple
+	IInfraredFrameReference *infraredRef;
+	if (SUCCEEDED(frame->get_InfraredFrameReference(&infraredRef))) {
+		if (SUCCEEDED(infraredRef->get_RelativeTime(&time))) {
+			m_pairing.push(INFRARED_STREAM, time);
+		}
+		infraredRef->Release();
+	}
+
+	//Only the colour frame in hand can be gathered from, not older ones in
+	//the history
+	bool matched = m_pairing.matchLatest(DEPTH_STREAM, 1u << COLOUR_STREAM, m_slots);
+	m_pairing.countMatch(matched);
+
+	if (matched) {
+		hr = S_OK;
+		if (!m_hasMapping || depthTime != m_mappedDepthTime) {
+			hr = m_mapper->MapDepthFrameToColorSpace(depthPixels, depth, depthPixels, &m_colourPoints[0]);
+			m_hasMapping = SUCCEEDED(hr);
+			m_mappedDepthTime = depthTime;
+		}
+
+		if (SUCCEEDED(hr)) {
+			int originX, originY, width, height;
+			getRegion(originX, originY, width, height);
+
+			for (int y = 0; y < height; y++) {
+				colourconversion::gatherYuy2ToRgb24(colour, colourWidth, colourHeight,
+					&m_colourPoints[(originY + y) * depthWidth + originX], width, data + y * width * 3);
+			}
+		}
+	}
+	else {
+		hr = E_PENDING;
+	}
+
+	colourFrame->Release();
+	depthFrame->Release();
+
+	return hr;
+}
+
+//Fuses the short and long exposure frames of the pair, which must both be
+//part of this multi-source frame
+HRESULT SynchronizedAdapter::copyHdrFrame(IMultiSourceFrame *frame, BYTE *data) {
+	IInfraredFrameReference *shortRef;
+	if (FAILED(frame->get_InfraredFrameReference(&shortRef))) {
+		return E_FAIL;
+	}
+
+	IInfraredFrame *shortFrame;
+	HRESULT hr = shortRef->AcquireFrame(&shortFrame);
+	shortRef->Release();
+	if (FAILED(hr)) {
+		return hr;
+	}
+
+	ILongExposureInfraredFrameReference *longRef;
+	ILongExposureInfraredFrame *longFrame = nullptr;
+	if (SUCCEEDED(frame->get_LongExposureInfraredFrameReference(&longRef))) {
+		if (FAILED(longRef->AcquireFrame(&longFrame))) {
+			longFrame = nullptr;
+		}
+		longRef->Release();
+	}
+
+	UINT shortCapacity, longCapacity;
+	UINT16 *shortExposure, *longExposure;
+	TIMESPAN shortTime, longTime;
+
+	if (longFrame == nullptr
+		|| FAILED(shortFrame->AccessUnderlyingBuffer(&shortCapacity, &shortExposure))
+		|| FAILED(longFrame->AccessUnderlyingBuffer(&longCapacity, &longExposure))
+		|| FAILED(shortFrame->get_RelativeTime(&shortTime))
+		|| FAILED(longFrame->get_RelativeTime(&longTime))
+		|| shortCapacity < depthPixels
+		|| longCapacity < depthPixels) {
+
+		if (longFrame != nullptr) {
+			longFrame->Release();
+		}
+		shortFrame->Release();
+		return E_PENDING;
+	}
+
+	m_exposurePairing.push(SHORT_EXPOSURE, shortTime);
+	if (longTime != m_exposurePairing.getLatestTime(LONG_EXPOSURE)) {
+		m_exposurePairing.push(LONG_EXPOSURE, longTime);
+	}
+
+	//Only the frames in hand can be merged, not older ones in the history
+	bool matched = m_exposurePairing.match(SHORT_EXPOSURE, m_exposureSlots)
+		&& m_exposureSlots[LONG_EXPOSURE] == m_exposurePairing.getLatestSlot(LONG_EXPOSURE);
+	m_exposurePairing.countMatch(matched);
+
+	if (matched) {
+		m_exposureRatio = infraredconversion::exposureRatio(shortExposure, longExposure,
+			depthPixels, m_exposureRatio);
+
+		int originX, originY, width, height;
+		getRegion(originX, originY, width, height);
+
+		for (int y = 0; y < height; y++) {
+			int offset = (originY + y) * depthWidth + originX;
+
+			if (m_output == HDR_FLOAT_OUTPUT) {
+				infraredconversion::mergeExposures(shortExposure + offset, longExposure + offset, width,
+					m_exposureRatio, reinterpret_cast<float*>(data) + y * width);
+			}
+			else {
+				infraredconversion::mergeExposures(shortExposure + offset, longExposure + offset, width,
+					m_exposureRatio, reinterpret_cast<UINT16*>(data) + y * width);
+			}
+		}
+	}
+
+	longFrame->Release();
+	shortFrame->Release();
+
+	return matched ? S_OK : E_PENDING;
+}
+
+//Tuples are stamped with the depth time they were matched against, HDR
+//pairs with the short exposure time
+HRESULT SynchronizedAdapter::getRelativeTime(IMultiSourceFrame *frame, TIMESPAN *time) {
+	if (isHdr()) {
+		IInfraredFrameReference *infraredRef;
+		HRESULT hr = frame->get_InfraredFrameReference(&infraredRef);
+		if (FAILED(hr)) {
+			return hr;
+		}
+
+		hr = infraredRef->get_RelativeTime(time);
+		infraredRef->Release();
+		return hr;
+	}
+
+	IDepthFrameReference *depthRef;
+	HRESULT hr = frame->get_DepthFrameReference(&depthRef);
+	if (FAILED(hr)) {
+		return hr;
+	}
+
+	hr = depthRef->get_RelativeTime(time);
+	depthRef->Release();
+	return hr;
+}
+
+void SynchronizedAdapter::getFrameMetadata(IMultiSourceFrame *frame, FrameMetadata &metadata) {
+	if (isHdr()) {
+		metadata.add("InfraredRelativeTime",
+			static_cast<double>(m_exposurePairing.getTime(SHORT_EXPOSURE, m_exposureSlots[SHORT_EXPOSURE])));
+		metadata.add("LongExposureInfraredRelativeTime",
+			static_cast<double>(m_exposurePairing.getTime(LONG_EXPOSURE, m_exposureSlots[LONG_EXPOSURE])));
+		metadata.add("HdrExposureRatio", m_exposureRatio);
+		metadata.add("UnmatchedTuples", static_cast<double>(m_exposurePairing.getUnmatchedCount()));
+		return;
+	}
+
+	metadata.add("DepthRelativeTime", static_cast<double>(m_pairing.getTime(DEPTH_STREAM, m_slots[DEPTH_STREAM])));
+	metadata.add("InfraredRelativeTime", static_cast<double>(m_pairing.getTime(INFRARED_STREAM, m_slots[INFRARED_STREAM])));
+	metadata.add("ColourRelativeTime", static_cast<double>(m_pairing.getTime(COLOUR_STREAM, m_slots[COLOUR_STREAM])));
+	metadata.add("UnmatchedTuples", static_cast<double>(m_pairing.getUnmatchedCount()));
+}
+
+imaqkit::frametypes::FRAMETYPE SynchronizedAdapter::getFrameType() const { 
+	switch (m_output) {
+	case REGISTERED_OUTPUT:
+		return imaqkit::frametypes::RGB24_PACKED;
+	case HDR_FLOAT_OUTPUT:
+		return imaqkit::frametypes::FLOAT;
+	default:
+		return imaqkit::frametypes::MONO16;
+	}
+}
+int SynchronizedAdapter::getMaxHeight() const { return m_output == STACKED_OUTPUT ? depthHeight * 2 : depthHeight; }
+int SynchronizedAdapter::getMaxWidth() const { return depthWidth; }
+int SynchronizedAdapter::getNumberOfBands() const { return m_output == REGISTERED_OUTPUT ? 3 : 1; }
+
+bool SynchronizedAdapter::writesFrameInPlace() const {
+	return true;
+}
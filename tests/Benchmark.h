@@ -0,0 +1,32 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+//Minimal timing for the benchmarks, each of which is a single source file
+//printing one line per kernel. Benchmarks only fail if a kernel cannot run;
+//the timings are for reading, not checking.
+namespace benchmark {
+	//Median time of one call of kernel in milliseconds, after a warm-up call
+	template <class Kernel>
+	double time(Kernel kernel, int runs = 15) {
+		kernel();
+
+		std::vector<double> times(runs);
+		for (int i = 0; i < runs; i++) {
+			std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+			kernel();
+			times[i] = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+		}
+
+		std::nth_element(times.begin(), times.begin() + runs / 2, times.end());
+		return times[runs / 2];
+	}
+
+	//Prints the time per frame and the throughput in output pixels
+	inline void report(const char *name, double milliseconds, int pixels) {
+		std::printf("%-40s %8.3f ms %8.1f Mpixel/s\n", name, milliseconds, pixels / (milliseconds * 1000.0));
+	}
+}
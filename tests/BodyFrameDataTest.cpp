@@ -0,0 +1,262 @@
+#include "../include/BodyFrameData.h"
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "Check.h"
+
+namespace {
+	//A body whose joints are derived from a seed, so every value is distinct
+	class SyntheticBody : public IBody {
+	public:
+		SyntheticBody(bool tracked, UINT64 id, int seed)
+			:m_tracked(tracked), m_id(id), m_seed(seed), m_failJoints(false) {}
+
+		static float position(int seed, int joint, int axis) {
+			return seed * 10.0f + joint * 0.25f + axis * 0.0625f;
+		}
+		static float orientation(int seed, int joint, int component) {
+			return seed * -1.0f + joint * 0.125f + component * 0.03125f;
+		}
+		static int state(int seed, int joint) {
+			return (seed + joint) % 3;
+		}
+
+		virtual HRESULT GetJoints(UINT capacity, Joint *joints) override {
+			if (m_failJoints) {
+				return E_FAIL;
+			}
+			for (UINT j = 0; j < capacity; j++) {
+				joints[j].JointType = static_cast<JointType>(j);
+				joints[j].Position.X = position(m_seed, j, 0);
+				joints[j].Position.Y = position(m_seed, j, 1);
+				joints[j].Position.Z = position(m_seed, j, 2);
+				joints[j].TrackingState = static_cast<TrackingState>(state(m_seed, j));
+			}
+			return S_OK;
+		}
+		virtual HRESULT GetJointOrientations(UINT capacity, JointOrientation *jointOrientations) override {
+			for (UINT j = 0; j < capacity; j++) {
+				jointOrientations[j].JointType = static_cast<JointType>(j);
+				jointOrientations[j].Orientation.x = orientation(m_seed, j, 0);
+				jointOrientations[j].Orientation.y = orientation(m_seed, j, 1);
+				jointOrientations[j].Orientation.z = orientation(m_seed, j, 2);
+				jointOrientations[j].Orientation.w = orientation(m_seed, j, 3);
+			}
+			return S_OK;
+		}
+		virtual HRESULT get_IsTracked(BOOLEAN *tracked) override {
+			*tracked = m_tracked;
+			return S_OK;
+		}
+		virtual HRESULT get_TrackingId(UINT64 *trackingId) override {
+			*trackingId = m_id;
+			return S_OK;
+		}
+		virtual HRESULT get_HandLeftState(HandState *handState) override {
+			*handState = HandState_Open;
+			return S_OK;
+		}
+		virtual HRESULT get_HandRightState(HandState *handState) override {
+			*handState = HandState_Lasso;
+			return S_OK;
+		}
+
+		bool m_tracked;
+		UINT64 m_id;
+		int m_seed;
+		bool m_failJoints;
+	};
+
+	//Records the shape and pointers of every metadata item
+	class RecordingFrame : public imaqkit::IAdaptorFrame {
+	public:
+		struct Item {
+			std::string name;
+			int dimensions;
+			size_t shape[3];
+			const void *data;
+		};
+
+		RecordingFrame() {}
+		virtual ~RecordingFrame() {}
+
+		const Item *find(const char *name) const {
+			for (size_t i = 0; i < m_items.size(); i++) {
+				if (m_items[i].name == name) {
+					return &m_items[i];
+				}
+			}
+			return nullptr;
+		}
+
+		virtual void addMetaItem(const char* name, double* item, size_t length) override {
+			add(name, 1, length, 0, 0, item);
+		}
+		virtual void addMetaItem(const char* name, double** item, size_t row, size_t col) override {
+			add(name, 2, row, col, 0, item);
+		}
+		virtual void addMetaItem(const char* name, double*** item, size_t row, size_t col, size_t depth) override {
+			add(name, 3, row, col, depth, item);
+		}
+
+		virtual void setImage(void*, int, int, int, int) override {}
+		virtual void* getImage(void) const override { return nullptr; }
+		virtual int* getDims(void) const override { return nullptr; }
+		virtual size_t getImageSize(void) const override { return 0; }
+		virtual imaqkit::frametypes::FRAMETYPE getFrameType(void) const override { return imaqkit::frametypes::MONO8; }
+		virtual imaqkit::colorspaces::COLORSPACE getColorSpace(void) const override { return imaqkit::colorspaces::MONOCHROME; }
+		virtual void setTime(double) override {}
+		virtual double getTime() const override { return 0; }
+		virtual void getMetaNames(const char**) const override {}
+		virtual int getNumMetaItems(void) const override { return static_cast<int>(m_items.size()); }
+		virtual void addMetaItem(const char*, double) override {}
+		virtual void addMetaItem(const char*, const char*) override {}
+		virtual void addMetaItemTimeVector(const char*, double) override {}
+		virtual void addMetaItem(const char*, bool*, size_t) override {}
+		virtual void destroy(void) override {}
+
+	private:
+		void add(const char *name, int dimensions, size_t rows, size_t columns, size_t depth, const void *data) {
+			Item item = { name, dimensions, { rows, columns, depth }, data };
+			m_items.push_back(item);
+		}
+
+		std::vector<Item> m_items;
+	};
+
+	const int BODIES = BodyFrameData::BODIES;
+	const int JOINTS = BodyFrameData::JOINTS;
+
+	void testRead() {
+		//Body 1 is not tracked, body 3 is missing and body 4 has no joints
+		SyntheticBody bodies[BODIES] = {
+			SyntheticBody(true, 0x123456789ABCDEF0ull, 1),
+			SyntheticBody(false, 7, 2),
+			SyntheticBody(true, 42, 3),
+			SyntheticBody(true, 1, 4),
+			SyntheticBody(true, 0xFFFFFFFFFFFFFFFFull, 5),
+			SyntheticBody(true, 0x100000000ull, 6),
+		};
+		bodies[4].m_failJoints = true;
+
+		IBody *pointers[BODIES];
+		for (int b = 0; b < BODIES; b++) {
+			pointers[b] = &bodies[b];
+		}
+		pointers[3] = nullptr;
+
+		BodyFrameData data;
+		data.read(pointers, BODIES);
+
+		const bool tracked[BODIES] = { true, false, true, false, true, true };
+		for (int b = 0; b < BODIES; b++) {
+			CHECK_EQUAL(tracked[b], data.isTracked(b));
+			CHECK_EQUAL(tracked[b] ? 1 : 0, data.tracked[b]);
+		}
+
+		//The 64-bit ids split into high and low words
+		CHECK_EQUAL(0x12345678u, data.trackingIds[0][0]);
+		CHECK_EQUAL(0x9ABCDEF0u, data.trackingIds[0][1]);
+		CHECK_EQUAL(0xFFFFFFFFu, data.trackingIds[4][0]);
+		CHECK_EQUAL(0xFFFFFFFFu, data.trackingIds[4][1]);
+		CHECK_EQUAL(1, data.trackingIds[5][0]);
+		CHECK_EQUAL(0, data.trackingIds[5][1]);
+
+		CHECK_EQUAL(HandState_Open, data.handStates[2][0]);
+		CHECK_EQUAL(HandState_Lasso, data.handStates[2][1]);
+
+		int mismatches = 0;
+		for (int b = 0; b < BODIES; b++) {
+			//Untracked bodies, and the joints of body 4, stay zero
+			bool hasJoints = tracked[b] && b != 4;
+			int seed = bodies[b].m_seed;
+
+			for (int j = 0; j < JOINTS; j++) {
+				for (int axis = 0; axis < 3; axis++) {
+					double expected = hasJoints ? SyntheticBody::position(seed, j, axis) : 0;
+					mismatches += data.positions[b][j][axis] != expected;
+				}
+				for (int component = 0; component < 4; component++) {
+					double expected = tracked[b] ? SyntheticBody::orientation(seed, j, component) : 0;
+					mismatches += data.orientations[b][j][component] != expected;
+				}
+				mismatches += data.jointStates[b][j] != (hasJoints ? SyntheticBody::state(seed, j) : 0);
+			}
+		}
+		CHECK_EQUAL(0, mismatches);
+
+		//A later frame without bodies clears the earlier ones
+		data.read(pointers, 0);
+		CHECK(!data.isTracked(0));
+		CHECK_EQUAL(0, data.positions[0][JOINTS - 1][2]);
+	}
+
+	void testAttach() {
+		SyntheticBody body(true, 99, 7);
+		IBody *pointers[1] = { &body };
+
+		BodyFrameData data;
+		data.read(pointers, 1);
+
+		RecordingFrame frame;
+		data.attach(&frame);
+		CHECK_EQUAL(6, frame.getNumMetaItems());
+
+		const RecordingFrame::Item *item = frame.find("BodyTracked");
+		CHECK(item != nullptr && item->dimensions == 1 && item->shape[0] == BODIES);
+		CHECK(item != nullptr && item->data == data.tracked);
+
+		//Two dimensional items are rows of the arrays, one per body
+		const char *matrices[] = { "BodyTrackingId", "HandStates", "JointTrackingStates" };
+		const double *firstRows[] = { data.trackingIds[0], data.handStates[0], data.jointStates[0] };
+		const size_t columns[] = { 2, 2, JOINTS };
+		for (int m = 0; m < 3; m++) {
+			item = frame.find(matrices[m]);
+			CHECK(item != nullptr);
+			if (item == nullptr) {
+				continue;
+			}
+			CHECK_EQUAL(2, item->dimensions);
+			CHECK_EQUAL(BODIES, item->shape[0]);
+			CHECK_EQUAL(columns[m], item->shape[1]);
+
+			double *const *rows = static_cast<double *const *>(item->data);
+			for (int b = 0; b < BODIES; b++) {
+				CHECK(rows[b] == firstRows[m] + b * columns[m]);
+			}
+		}
+
+		//Three dimensional items, read back through the row pointers
+		item = frame.find("JointPositions");
+		CHECK(item != nullptr);
+		if (item != nullptr) {
+			CHECK_EQUAL(3, item->dimensions);
+			CHECK_EQUAL(BODIES, item->shape[0]);
+			CHECK_EQUAL(JOINTS, item->shape[1]);
+			CHECK_EQUAL(3, item->shape[2]);
+
+			double **const *positions = static_cast<double **const *>(item->data);
+			CHECK_NEAR(SyntheticBody::position(7, 24, 2), positions[0][24][2], 0);
+			CHECK_EQUAL(0, positions[5][24][2]);
+		}
+
+		item = frame.find("JointOrientations");
+		CHECK(item != nullptr);
+		if (item != nullptr) {
+			CHECK_EQUAL(3, item->dimensions);
+			CHECK_EQUAL(4, item->shape[2]);
+
+			double **const *orientations = static_cast<double **const *>(item->data);
+			CHECK_NEAR(SyntheticBody::orientation(7, 11, 3), orientations[0][11][3], 0);
+		}
+	}
+}
+
+int main() {
+	testRead();
+	testAttach();
+
+	return TEST_RESULT();
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstdio>
+
+//Minimal checks for the unit tests, each of which is a single source file:
+//failures are reported and counted, and main returns TEST_RESULT().
+namespace check {
+	static int failures = 0;
+}
+
+#define CHECK(condition) \
+	do { \
+		if (!(condition)) { \
+			std::printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #condition); \
+			check::failures++; \
+		} \
+	} while (0)
+
+#define CHECK_EQUAL(expected, actual) \
+	do { \
+		long long expectedValue = static_cast<long long>(expected); \
+		long long actualValue = static_cast<long long>(actual); \
+		if (expectedValue != actualValue) { \
+			std::printf("%s:%d: CHECK_EQUAL(%s, %s) failed: %lld != %lld\n", __FILE__, __LINE__, \
+				#expected, #actual, expectedValue, actualValue); \
+			check::failures++; \
+		} \
+	} while (0)
+
+#define CHECK_NEAR(expected, actual, tolerance) \
+	do { \
+		double expectedValue = static_cast<double>(expected); \
+		double actualValue = static_cast<double>(actual); \
+		if (!(actualValue >= expectedValue - (tolerance) && actualValue <= expectedValue + (tolerance))) { \
+			std::printf("%s:%d: CHECK_NEAR(%s, %s, %s) failed: %g vs %g\n", __FILE__, __LINE__, \
+				#expected, #actual, #tolerance, expectedValue, actualValue); \
+			check::failures++; \
+		} \
+	} while (0)
+
+#define TEST_RESULT() \
+	(check::failures == 0 ? (std::printf("passed\n"), 0) : (std::printf("%d failures\n", check::failures), 1))
+
@@ -0,0 +1,130 @@
+#include "../include/ColourConversion.h"
+
+#include <limits>
+#include <vector>
+
+#include "Benchmark.h"
+
+using namespace colourconversion;
+
+namespace {
+	const int colourWidth = 1920;
+	const int colourHeight = 1080;
+
+	std::vector<BYTE> randomBytes(size_t size, unsigned int seed) {
+		std::vector<BYTE> bytes(size);
+		for (size_t i = 0; i < size; i++) {
+			seed = seed * 1664525 + 1013904223;
+			bytes[i] = static_cast<BYTE>(seed >> 8);
+		}
+		return bytes;
+	}
+
+	//Whole frames, as RGB24_1920x1080 converts them
+	void benchmarkConvertPaths(const std::vector<BYTE> &yuy2) {
+		std::vector<BYTE> rgb(colourWidth * colourHeight * 3);
+		const ConversionPath paths[] = { SCALAR_PATH, SSE2_PATH, AVX2_PATH };
+		const char *names[] = { "YUY2 to RGB24, scalar", "YUY2 to RGB24, SSE2", "YUY2 to RGB24, AVX2" };
+
+		for (int i = 0; i < 3; i++) {
+			if (paths[i] == AVX2_PATH && !hasAvx2()) {
+				std::printf("%-40s skipped, no AVX2\n", names[i]);
+				continue;
+			}
+			benchmark::report(names[i], benchmark::time([&]() {
+				convertYuy2ToRgb24(&yuy2[0], colourWidth, BT601, 0, 0, colourWidth, colourHeight, &rgb[0], paths[i]);
+			}), colourWidth * colourHeight);
+		}
+	}
+
+	//RGB24_960x540 and RGB24_480x270, against converting at full size
+	void benchmarkDownscale(const std::vector<BYTE> &yuy2) {
+		std::vector<BYTE> rgb(colourWidth * colourHeight * 3);
+		const int factors[] = { 2, 4 };
+		const char *names[] = { "YUY2 to RGB24, downscaled by 2", "YUY2 to RGB24, downscaled by 4" };
+
+		for (int i = 0; i < 2; i++) {
+			int width = colourWidth / factors[i];
+			int height = colourHeight / factors[i];
+			benchmark::report(names[i], benchmark::time([&]() {
+				downscaleYuy2ToRgb24(&yuy2[0], colourWidth, factors[i], BT601, 0, 0, width, height, &rgb[0]);
+			}), width * height);
+		}
+	}
+
+	//The planar formats write the same pixels as the packed ones
+	void benchmarkPlanar(const std::vector<BYTE> &yuy2) {
+		std::vector<BYTE> planes(colourWidth * colourHeight * 3);
+		int planeSize = colourWidth * colourHeight;
+
+		benchmark::report("YUY2 to planar RGB24", benchmark::time([&]() {
+			convertYuy2ToPlanar(&yuy2[0], colourWidth, BT601, 0, 0, colourWidth, colourHeight, planeSize, &planes[0]);
+		}), planeSize);
+		benchmark::report("YUY2 to planar RGB24, scalar", benchmark::time([&]() {
+			convertYuy2ToPlanar(&yuy2[0], colourWidth, BT601, 0, 0, colourWidth, colourHeight, planeSize, &planes[0],
+				SCALAR_PATH);
+		}), planeSize);
+		benchmark::report("YUY2 to planar RGB24, downscaled by 2", benchmark::time([&]() {
+			downscaleYuy2ToPlanar(&yuy2[0], colourWidth, 2, BT601, 0, 0, colourWidth / 2, colourHeight / 2,
+				planeSize / 4, &planes[0]);
+		}), planeSize / 4);
+	}
+
+	//RGB24_DEMOSAIC_1920x1080 with either method; the edge-aware time
+	//includes filling the green plane
+	void benchmarkDemosaic() {
+		std::vector<BYTE> mosaic = randomBytes(colourWidth * colourHeight, 11);
+		std::vector<BYTE> green(colourWidth * colourHeight);
+		std::vector<BYTE> rgb(colourWidth * colourHeight * 3);
+		const ConversionPath paths[] = { SCALAR_PATH, SSE2_PATH };
+		const char *bilinearNames[] = { "Bilinear demosaic, scalar", "Bilinear demosaic, SSE2" };
+		const char *edgeAwareNames[] = { "Edge-aware demosaic, scalar", "Edge-aware demosaic, SSE2" };
+
+		for (int i = 0; i < 2; i++) {
+			benchmark::report(bilinearNames[i], benchmark::time([&]() {
+				demosaicBilinear(&mosaic[0], colourWidth, colourHeight, 0, 0, colourWidth, colourHeight, &rgb[0], paths[i]);
+			}), colourWidth * colourHeight);
+		}
+		for (int i = 0; i < 2; i++) {
+			benchmark::report(edgeAwareNames[i], benchmark::time([&]() {
+				interpolateGreen(&mosaic[0], colourWidth, colourHeight, 0, colourHeight, &green[0], paths[i]);
+				demosaicEdgeAware(&mosaic[0], &green[0], colourWidth, colourHeight, 0, 0, colourWidth, colourHeight,
+					&rgb[0], paths[i]);
+			}), colourWidth * colourHeight);
+		}
+	}
+
+	//The registered format's sampling of the colour frame at each depth
+	//pixel, with a map like the sensor's: the depth view spread over the
+	//middle of the colour frame and its edges unmapped
+	void benchmarkGather(const std::vector<BYTE> &yuy2) {
+		const int depthWidth = 512;
+		const int depthHeight = 424;
+		std::vector<ColorSpacePoint> points(depthWidth * depthHeight);
+		std::vector<BYTE> rgb(depthWidth * depthHeight * 3);
+
+		for (int y = 0; y < depthHeight; y++) {
+			for (int x = 0; x < depthWidth; x++) {
+				ColorSpacePoint &point = points[y * depthWidth + x];
+				point.X = x < 16 || x >= depthWidth - 16 ? -std::numeric_limits<float>::infinity() : 200.0f + x * 2.95f;
+				point.Y = -30.0f + y * 2.6f;
+			}
+		}
+
+		benchmark::report("Gather YUY2 to RGB24 at depth pixels", benchmark::time([&]() {
+			gatherYuy2ToRgb24(&yuy2[0], colourWidth, colourHeight, &points[0], depthWidth * depthHeight, &rgb[0]);
+		}), depthWidth * depthHeight);
+	}
+}
+
+int main() {
+	std::vector<BYTE> yuy2 = randomBytes(colourWidth * colourHeight * 2, 7);
+
+	benchmarkConvertPaths(yuy2);
+	benchmarkDownscale(yuy2);
+	benchmarkPlanar(yuy2);
+	benchmarkDemosaic();
+	benchmarkGather(yuy2);
+
+	return 0;
+}
@@ -0,0 +1,325 @@
+#include "../include/ColourConversion.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+#include "Check.h"
+
+using namespace colourconversion;
+
+namespace {
+	const int sourceWidth = 256;
+	const int sourceHeight = 16;
+
+	unsigned int nextRandom(unsigned int &seed) {
+		seed = seed * 1664525 + 1013904223;
+		return seed >> 8;
+	}
+
+	std::vector<BYTE> randomBytes(size_t size, unsigned int seed) {
+		std::vector<BYTE> bytes(size);
+		for (size_t i = 0; i < size; i++) {
+			bytes[i] = static_cast<BYTE>(nextRandom(seed));
+		}
+		return bytes;
+	}
+
+	BYTE referenceClamp(double value) {
+		return static_cast<BYTE>(value <= 0 ? 0 : value >= 255 ? 255 : floor(value + 0.5));
+	}
+
+	//Video range YUV to full range RGB in double precision
+	void referenceRgb(Matrix matrix, double y, double u, double v, BYTE *rgb, size_t channelStride) {
+		const Coefficients &c = getCoefficients(matrix);
+		double luma = c.lumaScale * (y - 16);
+		u -= 128;
+		v -= 128;
+		rgb[0] = referenceClamp(luma + c.redFromV * v);
+		rgb[channelStride] = referenceClamp(luma + c.greenFromU * u + c.greenFromV * v);
+		rgb[channelStride * 2] = referenceClamp(luma + c.blueFromU * u);
+	}
+
+	void referenceConvert(const std::vector<BYTE> &yuy2, Matrix matrix, int originX, int originY,
+		int width, int height, BYTE *rgb) {
+
+		for (int y = 0; y < height; y++) {
+			for (int x = 0; x < width; x++) {
+				int column = originX + x;
+				const BYTE *pair = &yuy2[((originY + y) * sourceWidth + (column & ~1)) * 2];
+				referenceRgb(matrix, pair[(column & 1) * 2], pair[1], pair[3], rgb + (y * width + x) * 3, 1);
+			}
+		}
+	}
+
+	//Block averages of factor x factor luma and their pixel pairs' chroma
+	void referenceDownscale(const std::vector<BYTE> &yuy2, int factor, Matrix matrix, int originX, int originY,
+		int width, int height, BYTE *rgb) {
+
+		for (int y = 0; y < height; y++) {
+			for (int x = 0; x < width; x++) {
+				double luma = 0, u = 0, v = 0;
+				for (int row = 0; row < factor; row++) {
+					const BYTE *block = &yuy2[(((originY + y) * factor + row) * sourceWidth + (originX + x) * factor) * 2];
+					for (int i = 0; i < factor * 2; i += 4) {
+						luma += block[i] + block[i + 2];
+						u += block[i + 1];
+						v += block[i + 3];
+					}
+				}
+				double pairs = factor * factor / 2.0;
+				referenceRgb(matrix, luma / (factor * factor), u / pairs, v / pairs, rgb + (y * width + x) * 3, 1);
+			}
+		}
+	}
+
+	int maxDifference(const std::vector<BYTE> &a, const std::vector<BYTE> &b) {
+		int largest = 0;
+		for (size_t i = 0; i < a.size(); i++) {
+			int difference = abs(a[i] - b[i]);
+			if (difference > largest) {
+				largest = difference;
+			}
+		}
+		return largest;
+	}
+
+	//Planar to packed, for comparing the two layouts
+	std::vector<BYTE> interleave(const std::vector<BYTE> &planes, size_t planeSize) {
+		std::vector<BYTE> packed(planeSize * 3);
+		for (size_t i = 0; i < planeSize; i++) {
+			for (int channel = 0; channel < 3; channel++) {
+				packed[i * 3 + channel] = planes[channel * planeSize + i];
+			}
+		}
+		return packed;
+	}
+
+	//Regions exercising the odd first pixel, the vector bodies and the tails
+	struct Region {
+		int originX;
+		int originY;
+		int width;
+		int height;
+	};
+
+	const Region regions[] = {
+		{ 0, 0, sourceWidth, sourceHeight },
+		{ 1, 2, 37, 3 },
+		{ 3, 1, 200, 4 },
+		{ 2, 0, 1, 1 },
+		{ 5, 5, 130, 2 },
+	};
+	const int regionCount = sizeof(regions) / sizeof(regions[0]);
+
+	void testConvertPaths() {
+		std::vector<BYTE> yuy2 = randomBytes(sourceWidth * sourceHeight * 2, 11);
+
+		for (int m = 0; m < 2; m++) {
+			Matrix matrix = m == 0 ? BT601 : BT709;
+
+			for (int r = 0; r < regionCount; r++) {
+				const Region &region = regions[r];
+				size_t size = region.width * region.height * 3;
+				std::vector<BYTE> reference(size), scalar(size), sse2(size), avx2(size), automatic(size);
+
+				referenceConvert(yuy2, matrix, region.originX, region.originY, region.width, region.height, &reference[0]);
+				convertYuy2ToRgb24(&yuy2[0], sourceWidth, matrix, region.originX, region.originY,
+					region.width, region.height, &scalar[0], SCALAR_PATH);
+				convertYuy2ToRgb24(&yuy2[0], sourceWidth, matrix, region.originX, region.originY,
+					region.width, region.height, &sse2[0], SSE2_PATH);
+				convertYuy2ToRgb24(&yuy2[0], sourceWidth, matrix, region.originX, region.originY,
+					region.width, region.height, &automatic[0]);
+
+				//Single precision may round the other way on a half
+				CHECK(maxDifference(reference, scalar) <= 1);
+				CHECK(maxDifference(scalar, sse2) <= 1);
+				CHECK(maxDifference(scalar, automatic) <= 1);
+
+				if (hasAvx2()) {
+					convertYuy2ToRgb24(&yuy2[0], sourceWidth, matrix, region.originX, region.originY,
+						region.width, region.height, &avx2[0], AVX2_PATH);
+					CHECK(maxDifference(scalar, avx2) <= 1);
+					CHECK(maxDifference(avx2, automatic) == 0);
+				}
+			}
+		}
+
+		if (!hasAvx2()) {
+			std::printf("AVX2 not supported here, its path was not checked\n");
+		}
+	}
+
+	void testPlanarMatchesPacked() {
+		std::vector<BYTE> yuy2 = randomBytes(sourceWidth * sourceHeight * 2, 12);
+
+		for (int r = 0; r < regionCount; r++) {
+			const Region &region = regions[r];
+			size_t planeSize = region.width * region.height;
+			std::vector<BYTE> packed(planeSize * 3), scalarPlanes(planeSize * 3), sse2Planes(planeSize * 3);
+
+			convertYuy2ToRgb24(&yuy2[0], sourceWidth, BT601, region.originX, region.originY,
+				region.width, region.height, &packed[0], SCALAR_PATH);
+			convertYuy2ToPlanar(&yuy2[0], sourceWidth, BT601, region.originX, region.originY,
+				region.width, region.height, planeSize, &scalarPlanes[0], SCALAR_PATH);
+			convertYuy2ToPlanar(&yuy2[0], sourceWidth, BT601, region.originX, region.originY,
+				region.width, region.height, planeSize, &sse2Planes[0], SSE2_PATH);
+
+			CHECK_EQUAL(0, maxDifference(packed, interleave(scalarPlanes, planeSize)));
+			CHECK(maxDifference(packed, interleave(sse2Planes, planeSize)) <= 1);
+		}
+	}
+
+	void testDownscale() {
+		std::vector<BYTE> yuy2 = randomBytes(sourceWidth * sourceHeight * 2, 13);
+
+		for (int factor = 2; factor <= 4; factor += 2) {
+			int maxWidth = sourceWidth / factor;
+			int maxHeight = sourceHeight / factor;
+			const Region downscaled[] = {
+				{ 0, 0, maxWidth, maxHeight },
+				{ 1, 1, maxWidth - 3, maxHeight - 1 },
+				{ 3, 0, 6, 1 },
+				{ 2, 1, 1, 1 },
+			};
+
+			for (int r = 0; r < 4; r++) {
+				const Region &region = downscaled[r];
+				size_t planeSize = region.width * region.height;
+				std::vector<BYTE> reference(planeSize * 3), packed(planeSize * 3), planes(planeSize * 3);
+
+				referenceDownscale(yuy2, factor, BT709, region.originX, region.originY,
+					region.width, region.height, &reference[0]);
+				downscaleYuy2ToRgb24(&yuy2[0], sourceWidth, factor, BT709, region.originX, region.originY,
+					region.width, region.height, &packed[0]);
+				downscaleYuy2ToPlanar(&yuy2[0], sourceWidth, factor, BT709, region.originX, region.originY,
+					region.width, region.height, planeSize, &planes[0]);
+
+				CHECK(maxDifference(reference, packed) <= 1);
+				CHECK_EQUAL(0, maxDifference(packed, interleave(planes, planeSize)));
+			}
+		}
+	}
+
+	void testGather() {
+		std::vector<BYTE> yuy2 = randomBytes(sourceWidth * sourceHeight * 2, 14);
+
+		//Mapped and unmapped points, in the vector body and the tail
+		const int count = 11;
+		ColorSpacePoint points[count] = {
+			{ 0.0f, 0.0f }, { 10.4f, 3.6f }, { 255.4f, 15.4f }, { -INFINITY, -INFINITY },
+			{ 256.0f, 2.0f }, { 3.0f, -0.6f }, { 101.5f, 7.2f }, { 17.0f, 16.0f },
+			{ 6.6f, 6.6f }, { -INFINITY, -INFINITY }, { 255.0f, 0.0f },
+		};
+
+		std::vector<BYTE> rgb(count * 3), reference(count * 3);
+		gatherYuy2ToRgb24(&yuy2[0], sourceWidth, sourceHeight, points, count, &rgb[0]);
+
+		for (int i = 0; i < count; i++) {
+			float x = points[i].X + 0.5f;
+			float y = points[i].Y + 0.5f;
+
+			if (x >= 0 && x < sourceWidth && y >= 0 && y < sourceHeight) {
+				referenceConvert(yuy2, BT601, static_cast<int>(x), static_cast<int>(y), 1, 1, &reference[i * 3]);
+			}
+		}
+		CHECK(maxDifference(reference, rgb) <= 1);
+
+		//Unmapped points are black
+		CHECK_EQUAL(0, rgb[3 * 3] + rgb[3 * 3 + 1] + rgb[3 * 3 + 2]);
+		CHECK_EQUAL(0, rgb[4 * 3] + rgb[4 * 3 + 1] + rgb[4 * 3 + 2]);
+		CHECK_EQUAL(0, rgb[9 * 3] + rgb[9 * 3 + 1] + rgb[9 * 3 + 2]);
+	}
+
+	void testDemosaicPathsAgree() {
+		const int width = 70;
+		const int height = 12;
+		std::vector<BYTE> mosaic = randomBytes(width * height, 15);
+		const Region mosaicRegions[] = {
+			{ 0, 0, width, height },
+			{ 1, 1, 33, 5 },
+			{ 3, 2, 21, 9 },
+			{ 69, 11, 1, 1 },
+		};
+
+		std::vector<BYTE> scalarGreen(width * height), sse2Green(width * height);
+		interpolateGreen(&mosaic[0], width, height, 0, height, &scalarGreen[0], SCALAR_PATH);
+		interpolateGreen(&mosaic[0], width, height, 0, height, &sse2Green[0], SSE2_PATH);
+		CHECK_EQUAL(0, maxDifference(scalarGreen, sse2Green));
+
+		//Green sites keep their own value
+		int greenChanged = 0;
+		for (int y = 0; y < height; y++) {
+			for (int x = (y & 1); x < width; x += 2) {
+				if (scalarGreen[y * width + x] != mosaic[y * width + x]) {
+					greenChanged++;
+				}
+			}
+		}
+		CHECK_EQUAL(0, greenChanged);
+
+		for (int r = 0; r < 4; r++) {
+			const Region &region = mosaicRegions[r];
+			size_t size = region.width * region.height * 3;
+			std::vector<BYTE> scalar(size), sse2(size);
+
+			demosaicBilinear(&mosaic[0], width, height, region.originX, region.originY,
+				region.width, region.height, &scalar[0], SCALAR_PATH);
+			demosaicBilinear(&mosaic[0], width, height, region.originX, region.originY,
+				region.width, region.height, &sse2[0], SSE2_PATH);
+			CHECK_EQUAL(0, maxDifference(scalar, sse2));
+
+			demosaicEdgeAware(&mosaic[0], &scalarGreen[0], width, height, region.originX, region.originY,
+				region.width, region.height, &scalar[0], SCALAR_PATH);
+			demosaicEdgeAware(&mosaic[0], &scalarGreen[0], width, height, region.originX, region.originY,
+				region.width, region.height, &sse2[0], SSE2_PATH);
+			CHECK_EQUAL(0, maxDifference(scalar, sse2));
+		}
+	}
+
+	//Interior sites of the GRBG mosaic against the textbook bilinear weights
+	void testBilinearReference() {
+		const int width = 16;
+		const int height = 8;
+		std::vector<BYTE> mosaic = randomBytes(width * height, 16);
+		std::vector<BYTE> rgb(width * height * 3);
+
+		demosaicBilinear(&mosaic[0], width, height, 0, 0, width, height, &rgb[0]);
+
+		int mismatches = 0;
+		for (int y = 1; y < height - 1; y++) {
+			for (int x = 1; x < width - 1; x++) {
+				const BYTE *m = &mosaic[y * width + x];
+				int centre = m[0];
+				int horizontal = (m[-1] + m[1] + 1) / 2;
+				int vertical = (m[-width] + m[width] + 1) / 2;
+				int cross = (m[-1] + m[1] + m[-width] + m[width] + 2) / 4;
+				int diagonal = (m[-width - 1] + m[-width + 1] + m[width - 1] + m[width + 1] + 2) / 4;
+
+				int expected[3];
+				if (y % 2 == 0 && x % 2 == 0) { expected[0] = horizontal; expected[1] = centre; expected[2] = vertical; }
+				else if (y % 2 == 0) { expected[0] = centre; expected[1] = cross; expected[2] = diagonal; }
+				else if (x % 2 == 0) { expected[0] = diagonal; expected[1] = cross; expected[2] = centre; }
+				else { expected[0] = vertical; expected[1] = centre; expected[2] = horizontal; }
+
+				for (int channel = 0; channel < 3; channel++) {
+					if (rgb[(y * width + x) * 3 + channel] != expected[channel]) {
+						mismatches++;
+					}
+				}
+			}
+		}
+		CHECK_EQUAL(0, mismatches);
+	}
+}
+
+int main() {
+	testConvertPaths();
+	testPlanarMatchesPacked();
+	testDownscale();
+	testGather();
+	testDemosaicPathsAgree();
+	testBilinearReference();
+
+	return TEST_RESULT();
+}
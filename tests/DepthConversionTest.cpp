@@ -0,0 +1,404 @@
+#include "../include/DepthConversion.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+#include "Check.h"
+
+using namespace depthconversion;
+
+namespace {
+	//Whole history blocks plus a tail for the scalar path
+	const int count = HISTORY_BLOCK * 37 + 5;
+
+	unsigned int nextRandom(unsigned int &seed) {
+		seed = seed * 1664525 + 1013904223;
+		return seed >> 8;
+	}
+
+	//Depths over the full 16-bit range, a quarter of them invalid
+	std::vector<UINT16> randomDepth(unsigned int &seed) {
+		std::vector<UINT16> depth(count);
+		for (int i = 0; i < count; i++) {
+			unsigned int value = nextRandom(seed);
+			depth[i] = (value & 3) == 0 ? 0 : static_cast<UINT16>(value >> 2);
+		}
+		return depth;
+	}
+
+	//Lower middle of the valid readings, 0 when there are none
+	UINT16 referenceMedian(const std::vector<UINT16> &readings) {
+		std::vector<UINT16> valid;
+		for (size_t i = 0; i < readings.size(); i++) {
+			if (readings[i] != 0) {
+				valid.push_back(readings[i]);
+			}
+		}
+		if (valid.empty()) {
+			return 0;
+		}
+		std::sort(valid.begin(), valid.end());
+		return valid[(valid.size() - 1) / 2];
+	}
+
+	void testMedian(int window) {
+		unsigned int seed = 100 + window;
+		std::vector<UINT16> history(historySize(count, window), 0);
+		std::vector<UINT16> filtered(count);
+		std::vector<std::vector<UINT16> > frames(window, std::vector<UINT16>(count, 0));
+
+		int mismatches = 0;
+		for (int frame = 0; frame < window * 4; frame++) {
+			int slot = frame % window;
+			frames[slot] = randomDepth(seed);
+
+			//A few pixels with no valid reading in the whole window
+			if (frame >= window * 3) {
+				for (int i = 0; i < count; i += 29) {
+					frames[slot][i] = 0;
+				}
+			}
+
+			medianDepth(&frames[slot][0], count, window, slot, &history[0], &filtered[0]);
+
+			for (int i = 0; i < count; i++) {
+				std::vector<UINT16> readings(window);
+				for (int f = 0; f < window; f++) {
+					readings[f] = frames[f][i];
+				}
+				if (filtered[i] != referenceMedian(readings)) {
+					mismatches++;
+				}
+			}
+		}
+		CHECK_EQUAL(0, mismatches);
+	}
+
+	void testAverage() {
+		const UINT16 first[] = { 1000, 0, 2000, 0, 1000, 1000, 1000, 1000, 4000, 65535 };
+		const UINT16 second[] = { 2000, 500, 0, 0, 1000, 1000, 1000, 1000, 2000, 65535 };
+		const int size = 10;
+		std::vector<float> average(size, 0);
+		std::vector<UINT16> filtered(size);
+
+		averageDepth(first, size, 0.25f, &average[0], &filtered[0]);
+		for (int i = 0; i < size; i++) {
+			CHECK_EQUAL(first[i], filtered[i]);
+		}
+
+		averageDepth(second, size, 0.25f, &average[0], &filtered[0]);
+		//Blends with the previous average, starts fresh pixels and ignores
+		//invalid readings; both halves of the vector path and the tail
+		CHECK_EQUAL(1250, filtered[0]);
+		CHECK_EQUAL(500, filtered[1]);
+		CHECK_EQUAL(2000, filtered[2]);
+		CHECK_EQUAL(0, filtered[3]);
+		CHECK_EQUAL(1000, filtered[4]);
+		CHECK_EQUAL(3500, filtered[8]);
+		CHECK_EQUAL(65535, filtered[9]);
+	}
+
+	void testHoldInvalid() {
+		//Pixel 0 goes invalid, pixel 1 never has a reading; repeated at the
+		//tail so both paths are covered
+		const int size = 10;
+		const int maxAge = 2;
+		std::vector<UINT16> held(size, 0), age(size, 0), filtered(size);
+		std::vector<UINT16> depth(size, 700);
+		depth[1] = depth[9] = 0;
+		depth[0] = depth[8] = 1200;
+
+		holdInvalidDepth(&depth[0], size, maxAge, &held[0], &age[0], &filtered[0]);
+		CHECK_EQUAL(1200, filtered[0]);
+		CHECK_EQUAL(0, filtered[1]);
+		CHECK_EQUAL(1200, filtered[8]);
+
+		depth[0] = depth[8] = 0;
+		for (int frame = 1; frame <= maxAge + 1; frame++) {
+			holdInvalidDepth(&depth[0], size, maxAge, &held[0], &age[0], &filtered[0]);
+
+			UINT16 expected = frame <= maxAge ? 1200 : 0;
+			CHECK_EQUAL(expected, filtered[0]);
+			CHECK_EQUAL(expected, filtered[8]);
+			CHECK_EQUAL(0, filtered[1]);
+			CHECK_EQUAL(0, filtered[9]);
+			CHECK_EQUAL(700, filtered[4]);
+		}
+
+		depth[0] = depth[8] = 900;
+		holdInvalidDepth(&depth[0], size, maxAge, &held[0], &age[0], &filtered[0]);
+		CHECK_EQUAL(900, filtered[0]);
+		CHECK_EQUAL(900, filtered[8]);
+	}
+
+	void testMetresAndMono() {
+		unsigned int seed = 7;
+		std::vector<UINT16> depth = randomDepth(seed);
+		std::vector<float> metres(count);
+		std::vector<BYTE> mono(count);
+
+		const UINT16 minimum = 500;
+		const UINT16 maximum = 4500;
+		toMetres(&depth[0], count, &metres[0]);
+		toClippedMono8(&depth[0], count, minimum, maximum, &mono[0]);
+
+		int metreMismatches = 0;
+		int monoMismatches = 0;
+		for (int i = 0; i < count; i++) {
+			if (metres[i] != depth[i] * 0.001f) {
+				metreMismatches++;
+			}
+
+			int expected = 0;
+			if (depth[i] != 0) {
+				double clipped = std::min<double>(std::max<double>(depth[i], minimum), maximum);
+				expected = static_cast<int>((clipped - minimum) * 255.0 / (maximum - minimum) + 0.5);
+			}
+			//The vector path rounds half to even
+			if (abs(mono[i] - expected) > 1) {
+				monoMismatches++;
+			}
+		}
+		CHECK_EQUAL(0, metreMismatches);
+		CHECK_EQUAL(0, monoMismatches);
+	}
+
+	//Rays of a synthetic pinhole camera with the sensor's 512 pixel rows
+	void testCameraSpace() {
+		const float focal = 365.0f;
+		unsigned int seed = 9;
+		std::vector<UINT16> depth = randomDepth(seed);
+		std::vector<PointF> rays(count);
+		for (int i = 0; i < count; i++) {
+			rays[i].X = (i % 512 - 256.0f) / focal;
+			rays[i].Y = (212.0f - i / 512) / focal;
+		}
+
+		std::vector<float> planes[3];
+		for (int axis = 0; axis < 3; axis++) {
+			planes[axis].resize(count);
+			toCameraSpace(&depth[0], &rays[0], count, axis, &planes[axis][0]);
+		}
+
+		int mismatches = 0;
+		int invalidNonZero = 0;
+		for (int i = 0; i < count; i++) {
+			float z = depth[i] * 0.001f;
+			if (depth[i] == 0 && (planes[0][i] != 0 || planes[1][i] != 0 || planes[2][i] != 0)) {
+				invalidNonZero++;
+			}
+			//The vector path scales the depth before the ray
+			if (fabs(planes[0][i] - rays[i].X * z) > 1e-6f * (1 + fabs(rays[i].X * z))
+				|| fabs(planes[1][i] - rays[i].Y * z) > 1e-6f * (1 + fabs(rays[i].Y * z))
+				|| planes[2][i] != z) {
+				mismatches++;
+			}
+		}
+		CHECK_EQUAL(0, mismatches);
+		CHECK_EQUAL(0, invalidNonZero);
+	}
+
+	void testBodyMask() {
+		unsigned int seed = 8;
+		std::vector<UINT16> depth = randomDepth(seed);
+		std::vector<BYTE> bodyIndex(count);
+		std::vector<UINT16> masked(count);
+
+		for (int i = 0; i < count; i++) {
+			unsigned int value = nextRandom(seed);
+			bodyIndex[i] = (value & 1) != 0 ? 0xFF : static_cast<BYTE>(value % 6);
+		}
+
+		applyBodyMask(&depth[0], &bodyIndex[0], count, &masked[0]);
+
+		int mismatches = 0;
+		for (int i = 0; i < count; i++) {
+			if (masked[i] != (bodyIndex[i] == 0xFF ? 0 : depth[i])) {
+				mismatches++;
+			}
+		}
+		CHECK_EQUAL(0, mismatches);
+	}
+
+	//Colour pixel of a coordinate, and the extent of a splat towards its
+	//neighbour: 3 pixels without one, clamped to 1..8 pixels otherwise
+	int referencePixel(float coordinate) {
+		return static_cast<int>(floor(coordinate + 0.5));
+	}
+
+	int referenceExtent(bool hasNeighbour, float from, float to) {
+		if (!hasNeighbour) {
+			return 3;
+		}
+		int extent = referencePixel(to) - referencePixel(from);
+		return extent < 1 ? 1 : extent > 8 ? 8 : extent;
+	}
+
+	//Brute-force z-buffer: every splat is drawn in turn, keeping the nearest
+	//depth of each colour pixel
+	void referenceSplat(const std::vector<UINT16> &depth, const std::vector<ColorSpacePoint> &points,
+		int depthWidth, int depthHeight, int colourWidth, int colourHeight, std::vector<UINT16> &zbuffer) {
+
+		zbuffer.assign(colourWidth * colourHeight, 0xFFFF);
+
+		for (int v = 0; v < depthHeight; v++) {
+			for (int u = 0; u < depthWidth; u++) {
+				int i = v * depthWidth + u;
+				if (depth[i] == 0 || std::isinf(points[i].X)) {
+					continue;
+				}
+
+				bool right = u + 1 < depthWidth && !std::isinf(points[i + 1].X);
+				bool below = v + 1 < depthHeight && !std::isinf(points[i + depthWidth].X);
+				int x0 = referencePixel(points[i].X);
+				int y0 = referencePixel(points[i].Y);
+				int x1 = x0 + referenceExtent(right, points[i].X, right ? points[i + 1].X : 0);
+				int y1 = y0 + referenceExtent(below, points[i].Y, below ? points[i + depthWidth].Y : 0);
+
+				for (int y = y0; y < y1; y++) {
+					for (int x = x0; x < x1; x++) {
+						if (x >= 0 && x < colourWidth && y >= 0 && y < colourHeight) {
+							UINT16 &nearest = zbuffer[y * colourWidth + x];
+							nearest = depth[i] < nearest ? depth[i] : nearest;
+						}
+					}
+				}
+			}
+		}
+
+		for (size_t i = 0; i < zbuffer.size(); i++) {
+			if (zbuffer[i] == 0xFFFF) {
+				zbuffer[i] = 0;
+			}
+		}
+	}
+
+	//A background plane with a nearer patch shifted across it, so their
+	//splats overlap, plus invalid and unmapped pixels and an unmapped row
+	void testSplatToColour() {
+		const int depthWidth = 24;
+		const int depthHeight = 12;
+		const int colourWidth = 80;
+		const int colourHeight = 48;
+		unsigned int seed = 10;
+
+		std::vector<UINT16> depth(depthWidth * depthHeight);
+		std::vector<ColorSpacePoint> points(depthWidth * depthHeight);
+		for (int v = 0; v < depthHeight; v++) {
+			for (int u = 0; u < depthWidth; u++) {
+				int i = v * depthWidth + u;
+				bool near = u >= 8 && u < 14 && v >= 3 && v < 8;
+				unsigned int random = nextRandom(seed);
+
+				depth[i] = static_cast<UINT16>(near ? 800 + random % 50 : 3000 + random % 500);
+				points[i].X = u * 2.7f - 3.0f + (near ? 5.0f : 0.0f) + (random % 100) * 0.004f;
+				points[i].Y = v * 3.6f - 2.0f + (near ? 2.0f : 0.0f);
+
+				if (random % 13 == 0) {
+					depth[i] = 0;
+				}
+				if (random % 17 == 0 || v == 10) {
+					points[i].X = points[i].Y = -INFINITY;
+				}
+			}
+		}
+
+		std::vector<float> top(depthHeight), bottom(depthHeight);
+		colourRowBounds(&points[0], depthWidth, depthHeight, &top[0], &bottom[0]);
+
+		int boundMismatches = 0;
+		for (int v = 0; v < depthHeight; v++) {
+			float lowest = 1e9f, highest = -1e9f;
+			for (int u = 0; u < depthWidth; u++) {
+				const ColorSpacePoint &point = points[v * depthWidth + u];
+				if (!std::isinf(point.Y)) {
+					lowest = std::min(lowest, point.Y);
+					highest = std::max(highest, point.Y);
+				}
+			}
+			if (lowest > highest ? top[v] <= bottom[v] : top[v] != lowest || bottom[v] != highest) {
+				boundMismatches++;
+			}
+		}
+		CHECK_EQUAL(0, boundMismatches);
+
+		ColourMapping mapping = { &depth[0], &points[0], &top[0], &bottom[0], depthWidth, depthHeight };
+		std::vector<UINT16> reference;
+		referenceSplat(depth, points, depthWidth, depthHeight, colourWidth, colourHeight, reference);
+
+		//The whole frame in uneven bands, and a region in one band
+		const int regions[][4] = { { 0, 0, colourWidth, colourHeight }, { 7, 5, 41, 30 } };
+		for (int r = 0; r < 2; r++) {
+			int originX = regions[r][0], originY = regions[r][1], width = regions[r][2], height = regions[r][3];
+			std::vector<UINT16> colourDepth(width * height, 1);
+
+			if (r == 0) {
+				const int bands[] = { 0, 7, 20, 21, height };
+				for (int b = 0; b < 4; b++) {
+					splatToColour(mapping, originX, originY, width, bands[b], bands[b + 1], &colourDepth[0]);
+				}
+			}
+			else {
+				splatToColour(mapping, originX, originY, width, 0, height, &colourDepth[0]);
+			}
+
+			int mismatches = 0;
+			for (int y = 0; y < height; y++) {
+				for (int x = 0; x < width; x++) {
+					if (colourDepth[y * width + x] != reference[(originY + y) * colourWidth + originX + x]) {
+						mismatches++;
+					}
+				}
+			}
+			CHECK_EQUAL(0, mismatches);
+		}
+
+		//The scene really overlaps: the near patch hides background the
+		//background alone would have drawn
+		std::vector<UINT16> background(depth), backgroundOnly;
+		for (size_t i = 0; i < background.size(); i++) {
+			background[i] = background[i] < 1000 ? 0 : background[i];
+		}
+		referenceSplat(background, points, depthWidth, depthHeight, colourWidth, colourHeight, backgroundOnly);
+
+		int occluded = 0;
+		for (size_t i = 0; i < reference.size(); i++) {
+			if (backgroundOnly[i] != 0 && reference[i] != 0 && reference[i] < 1000) {
+				occluded++;
+			}
+		}
+		CHECK(occluded > 0);
+	}
+
+	void testFillRowGaps() {
+		UINT16 row[] = { 0, 0, 800, 0, 0, 1000, 0, 0, 0, 0, 600, 0, 700, 0 };
+		const UINT16 expected[] = { 0, 0, 800, 1000, 1000, 1000, 0, 0, 0, 0, 600, 700, 700, 0 };
+		const int width = sizeof(row) / sizeof(row[0]);
+
+		fillRowGaps(row, width, 3);
+		for (int i = 0; i < width; i++) {
+			CHECK_EQUAL(expected[i], row[i]);
+		}
+	}
+}
+
+int main() {
+	//Vector windows, then even ones on the scalar path
+	for (int window = 3; window <= MAX_HISTORY_WINDOW; window += 2) {
+		testMedian(window);
+	}
+	testMedian(2);
+	testMedian(4);
+
+	testAverage();
+	testHoldInvalid();
+	testMetresAndMono();
+	testCameraSpace();
+	testBodyMask();
+	testSplatToColour();
+	testFillRowGaps();
+
+	return TEST_RESULT();
+}
@@ -0,0 +1,102 @@
+#include "../include/FrameBufferPool.h"
+
+#include <vector>
+
+#include "Check.h"
+
+namespace {
+	//Frame sizes of a few device formats: colour, depth, body index
+	const size_t formatSizes[] = { 1920 * 1080 * 3, 512 * 424 * 2, 512 * 424 };
+	const int formatCount = 3;
+
+	size_t sizeClassOf(size_t size) {
+		return (size + FrameBufferPool::SIZE_CLASS_GRANULARITY - 1) / FrameBufferPool::SIZE_CLASS_GRANULARITY
+			* FrameBufferPool::SIZE_CLASS_GRANULARITY;
+	}
+
+	void testBuffersAreAlignedAndRecycled() {
+		FrameBufferPool pool;
+
+		BYTE *first = pool.acquire(1000);
+		CHECK(first != nullptr);
+		CHECK_EQUAL(0, reinterpret_cast<size_t>(first) % FrameBufferPool::ALIGNMENT);
+		CHECK_EQUAL(FrameBufferPool::SIZE_CLASS_GRANULARITY, pool.getBytesOutstanding());
+
+		//The whole size class is usable
+		for (size_t i = 0; i < FrameBufferPool::SIZE_CLASS_GRANULARITY; i++) {
+			first[i] = static_cast<BYTE>(i);
+		}
+
+		pool.release(first);
+		CHECK_EQUAL(0, pool.getBytesOutstanding());
+		CHECK_EQUAL(FrameBufferPool::SIZE_CLASS_GRANULARITY, pool.getBytesCached());
+
+		//Any size of the same class reuses the buffer
+		CHECK(pool.acquire(4000) == first);
+		CHECK_EQUAL(1, pool.getHitCount());
+		CHECK_EQUAL(1, pool.getMissCount());
+
+		pool.release(first);
+		pool.release(nullptr);
+		pool.trim();
+		CHECK_EQUAL(0, pool.getBytesCached());
+	}
+
+	//Starting and stopping captures of changing formats and queue depths,
+	//as a user would: once every format has run at its deepest queue no
+	//memory is allocated, and the cache neither grows nor shrinks.
+	void testStartStopChurnKeepsMemoryFlat() {
+		FrameBufferPool pool;
+		const int queueDepths[] = { 2, 8, 5, 3 };
+		const int depthCount = 4;
+		const int maxDepth = 8;
+		const int sessions = 3000;
+		//Every format has met every depth by then
+		const int warmup = formatCount * depthCount;
+
+		size_t expectedCached = 0;
+		for (int i = 0; i < formatCount; i++) {
+			expectedCached += maxDepth * sizeClassOf(formatSizes[i]);
+		}
+
+		std::vector<BYTE*> ring(maxDepth);
+		unsigned int acquired = 0;
+		int unexpected = 0;
+		for (int session = 0; session < sessions; session++) {
+			size_t size = formatSizes[session % formatCount];
+			int depth = queueDepths[session % depthCount];
+
+			for (int i = 0; i < depth; i++) {
+				ring[i] = pool.acquire(size);
+				CHECK(ring[i] != nullptr);
+			}
+			acquired += depth;
+			if (pool.getBytesOutstanding() != depth * sizeClassOf(size)) {
+				unexpected++;
+			}
+
+			for (int i = 0; i < depth; i++) {
+				pool.release(ring[i]);
+			}
+			if (pool.getBytesOutstanding() != 0) {
+				unexpected++;
+			}
+
+			if (session >= warmup && pool.getBytesCached() != expectedCached) {
+				unexpected++;
+			}
+		}
+
+		CHECK_EQUAL(0, unexpected);
+		CHECK_EQUAL(expectedCached, pool.getBytesCached());
+		CHECK_EQUAL(formatCount * maxDepth, pool.getMissCount());
+		CHECK_EQUAL(acquired - formatCount * maxDepth, pool.getHitCount());
+	}
+}
+
+int main() {
+	testBuffersAreAlignedAndRecycled();
+	testStartStopChurnKeepsMemoryFlat();
+
+	return TEST_RESULT();
+}
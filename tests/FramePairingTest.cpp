@@ -0,0 +1,169 @@
+#include "../include/FramePairing.h"
+
+#include "Check.h"
+
+namespace {
+	//One frame period at 30 fps, in 100 ns ticks
+	const TIMESPAN period = 333333;
+
+	void testPushCyclesSlots() {
+		FramePairing pairing(2);
+
+		CHECK_EQUAL(-1, pairing.getLatestSlot(0));
+		CHECK_EQUAL(0, pairing.getLatestTime(0));
+
+		for (int i = 0; i < 2 * FramePairing::HISTORY; i++) {
+			int slot = pairing.push(0, i * period);
+			CHECK_EQUAL(i % FramePairing::HISTORY, slot);
+			CHECK_EQUAL(slot, pairing.getLatestSlot(0));
+			CHECK_EQUAL(i * period, pairing.getLatestTime(0));
+			CHECK_EQUAL(i * period, pairing.getTime(0, slot));
+		}
+
+		//Only the last HISTORY frames can be found
+		CHECK_EQUAL(-1, pairing.find(0, 0));
+		CHECK(pairing.find(0, FramePairing::HISTORY * period) >= 0);
+	}
+
+	void testFindTakesClosestWithinTolerance() {
+		FramePairing pairing(1, 1000);
+
+		pairing.push(0, 10000);
+		pairing.push(0, 11500);
+		pairing.push(0, 13000);
+
+		CHECK_EQUAL(1, pairing.find(0, 11000));
+		CHECK_EQUAL(1, pairing.find(0, 12200));
+		CHECK_EQUAL(2, pairing.find(0, 12300));
+		CHECK_EQUAL(2, pairing.find(0, 14000));
+		CHECK_EQUAL(-1, pairing.find(0, 14001));
+		CHECK_EQUAL(-1, pairing.find(0, 8999));
+	}
+
+	void testMatchNeedsEveryStream() {
+		FramePairing pairing(3);
+		int slots[FramePairing::MAX_STREAMS];
+
+		CHECK(!pairing.match(0, slots));
+
+		pairing.push(0, 10 * period);
+		pairing.push(1, 10 * period + 1000);
+		CHECK(!pairing.match(0, slots));
+
+		//Streams lag the reference by a fraction of a frame
+		pairing.push(2, 9 * period);
+		pairing.push(2, 10 * period - 2000);
+		CHECK(pairing.match(0, slots));
+		CHECK_EQUAL(0, slots[0]);
+		CHECK_EQUAL(0, slots[1]);
+		CHECK_EQUAL(1, slots[2]);
+
+		//A new reference frame no other stream has caught up with
+		pairing.push(0, 11 * period);
+		CHECK(!pairing.match(0, slots));
+
+		pairing.push(1, 11 * period);
+		pairing.push(2, 11 * period + FramePairing::DEFAULT_TOLERANCE);
+		CHECK(pairing.match(0, slots));
+		CHECK_EQUAL(1, slots[0]);
+		CHECK_EQUAL(1, slots[1]);
+		CHECK_EQUAL(2, slots[2]);
+	}
+
+	//Recorded times where the reader hands over the same depth frame again
+	//with a newer colour frame: the best match for the depth is then an
+	//older colour frame than the one in hand
+	void testMatchLatestRejectsOlderFrames() {
+		const TIMESPAN depth[] = { 1000000, 1333333, 1333333 };
+		const TIMESPAN colour[] = { 1033333, 1366666, 1600000 };
+		const bool delivered[] = { true, true, false };
+		FramePairing pairing(2);
+		int slots[FramePairing::MAX_STREAMS];
+
+		for (int i = 0; i < 3; i++) {
+			pairing.push(0, depth[i]);
+			if (colour[i] != pairing.getLatestTime(1)) {
+				pairing.push(1, colour[i]);
+			}
+
+			CHECK_EQUAL(delivered[i], pairing.matchLatest(0, 1u << 1, slots));
+			if (delivered[i]) {
+				CHECK_EQUAL(colour[i], pairing.getTime(1, slots[1]));
+			}
+		}
+
+		//The plain match still finds the older frame
+		CHECK(pairing.match(0, slots));
+		CHECK_EQUAL(1366666, pairing.getTime(1, slots[1]));
+
+		//Streams outside the mask are matched from history
+		CHECK(pairing.matchLatest(0, 0, slots));
+		CHECK(!pairing.matchLatest(0, 1u << 1, slots));
+	}
+
+	//Recorded stacked tuples: the infrared rows are copied from the frame in
+	//hand, colour only validates the match and may come from the history
+	void testStackedTuples() {
+		const TIMESPAN depth[] = { 1000000, 1333333, 1666666, 2000000 };
+		//The third infrared frame repeats the second
+		const TIMESPAN infrared[] = { 1000000, 1333333, 1333333, 2000000 };
+		const TIMESPAN colour[] = { 1100000, 1433333, 1900000, 2200000 };
+		const bool delivered[] = { true, true, false, true };
+		const int depthStream = 0, infraredStream = 1, colourStream = 2;
+		FramePairing pairing(3);
+		int slots[FramePairing::MAX_STREAMS];
+
+		for (int i = 0; i < 4; i++) {
+			pairing.push(depthStream, depth[i]);
+			pairing.push(infraredStream, infrared[i]);
+			if (colour[i] != pairing.getLatestTime(colourStream)) {
+				pairing.push(colourStream, colour[i]);
+			}
+
+			bool matched = pairing.matchLatest(depthStream, 1u << infraredStream, slots);
+			CHECK_EQUAL(delivered[i], matched);
+		}
+
+		//The last tuple took the closer, older colour frame
+		CHECK_EQUAL(1900000, pairing.getTime(colourStream, slots[colourStream]));
+	}
+
+	void testCountsAndReset() {
+		FramePairing pairing(2);
+
+		pairing.countMatch(true);
+		pairing.countMatch(false);
+		pairing.countMatch(true);
+		CHECK_EQUAL(2, pairing.getMatchedCount());
+		CHECK_EQUAL(1, pairing.getUnmatchedCount());
+
+		pairing.push(0, period);
+		pairing.reset();
+		CHECK_EQUAL(0, pairing.getMatchedCount());
+		CHECK_EQUAL(0, pairing.getUnmatchedCount());
+		CHECK_EQUAL(-1, pairing.getLatestSlot(0));
+		CHECK_EQUAL(-1, pairing.find(0, period));
+	}
+
+	void testStreamCountIsClamped() {
+		FramePairing pairing(FramePairing::MAX_STREAMS + 2);
+		int slots[FramePairing::MAX_STREAMS];
+
+		for (int i = 0; i < FramePairing::MAX_STREAMS; i++) {
+			pairing.push(i, period);
+		}
+		CHECK(pairing.match(0, slots));
+	}
+}
+
+int main() {
+	testPushCyclesSlots();
+	testFindTakesClosestWithinTolerance();
+	testMatchNeedsEveryStream();
+	testMatchLatestRejectsOlderFrames();
+	testStackedTuples();
+	testCountsAndReset();
+	testStreamCountIsClamped();
+
+	return TEST_RESULT();
+}
@@ -0,0 +1,109 @@
+#include "../include/FrameRegion.h"
+
+#include <vector>
+
+#include "Check.h"
+
+namespace {
+	const int frameWidth = 37;
+	const int frameHeight = 23;
+
+	//Every byte of the frame tells its column, row and byte in the pixel
+	BYTE frameByte(int x, int y, int b) {
+		return static_cast<BYTE>(x * 7 + y * 31 + b * 101);
+	}
+
+	std::vector<BYTE> makeFrame(int bytesPerPixel) {
+		std::vector<BYTE> frame(frameWidth * frameHeight * bytesPerPixel);
+		for (int y = 0; y < frameHeight; y++) {
+			for (int x = 0; x < frameWidth; x++) {
+				for (int b = 0; b < bytesPerPixel; b++) {
+					frame[(y * frameWidth + x) * bytesPerPixel + b] = frameByte(x, y, b);
+				}
+			}
+		}
+		return frame;
+	}
+
+	//Crops the region in bands of bandRows rows, as the adapters do, into a
+	//buffer with a guard byte past the region, and checks every byte
+	void checkRegion(int bytesPerPixel, int originX, int originY, int width, int height, int bandRows) {
+		std::vector<BYTE> frame = makeFrame(bytesPerPixel);
+		size_t regionSize = width * height * bytesPerPixel;
+		std::vector<BYTE> region(regionSize + 1, 0xA5);
+
+		for (int top = 0; top < frameHeight; top += bandRows) {
+			int rows = top + bandRows < frameHeight ? bandRows : frameHeight - top;
+			frameregion::copyRegion(&frame[top * frameWidth * bytesPerPixel], frameWidth, bytesPerPixel, top, rows,
+				originX, originY, width, height, &region[0]);
+		}
+
+		int errors = 0;
+		for (int y = 0; y < height; y++) {
+			for (int x = 0; x < width; x++) {
+				for (int b = 0; b < bytesPerPixel; b++) {
+					if (region[(y * width + x) * bytesPerPixel + b] != frameByte(originX + x, originY + y, b)) {
+						errors++;
+					}
+				}
+			}
+		}
+		CHECK_EQUAL(0, errors);
+		CHECK_EQUAL(0xA5, region[regionSize]);
+	}
+
+	void testWholeFrame() {
+		checkRegion(1, 0, 0, frameWidth, frameHeight, frameHeight);
+		checkRegion(2, 0, 0, frameWidth, frameHeight, 5);
+	}
+
+	//Full width regions take the single copy path
+	void testFullWidthRows() {
+		checkRegion(2, 0, 3, frameWidth, 11, frameHeight);
+		checkRegion(2, 0, 3, frameWidth, 11, 4);
+		checkRegion(4, 0, 1, frameWidth, 21, 1);
+	}
+
+	void testPartialWidthRows() {
+		checkRegion(1, 5, 2, 13, 9, frameHeight);
+		checkRegion(2, 4, 7, 32, 16, 3);
+		checkRegion(2, 0, 0, 1, 1, 2);
+		checkRegion(2, frameWidth - 1, frameHeight - 1, 1, 1, 7);
+	}
+
+	//The depth and infrared formats accept odd origins, and the converted
+	//colour formats odd widths
+	void testOddOrigins() {
+		checkRegion(2, 3, 5, 17, 7, frameHeight);
+		checkRegion(2, 1, 1, 36, 22, 4);
+		checkRegion(2, 7, 0, 30, frameHeight, 6);
+		checkRegion(3, 9, 11, 15, 3, 2);
+	}
+
+	//Bands wholly above or below the region write nothing
+	void testBandsOutsideRegion() {
+		std::vector<BYTE> frame = makeFrame(2);
+		std::vector<BYTE> region(10 * 4 * 2, 0xA5);
+
+		frameregion::copyRegion(&frame[0], frameWidth, 2, 0, 6, 3, 6, 10, 4, &region[0]);
+		frameregion::copyRegion(&frame[10 * frameWidth * 2], frameWidth, 2, 10, 5, 3, 6, 10, 4, &region[0]);
+
+		int touched = 0;
+		for (size_t i = 0; i < region.size(); i++) {
+			if (region[i] != 0xA5) {
+				touched++;
+			}
+		}
+		CHECK_EQUAL(0, touched);
+	}
+}
+
+int main() {
+	testWholeFrame();
+	testFullWidthRows();
+	testPartialWidthRows();
+	testOddOrigins();
+	testBandsOutsideRegion();
+
+	return TEST_RESULT();
+}
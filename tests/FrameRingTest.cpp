@@ -0,0 +1,224 @@
+#include "../include/FrameRing.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "Check.h"
+
+namespace {
+	struct TestSlot {
+		unsigned int sequence;
+		//Set by whichever thread holds the slot, to catch a slot held by both
+		int owner;
+	};
+
+	typedef FrameRing<TestSlot> Ring;
+
+	enum Owner { NOBODY, PRODUCER, CONSUMER };
+
+	const unsigned int depth = 4;
+
+	struct Result {
+		unsigned int produced;
+		//Frames counted the way the capture thread counts them
+		unsigned int counted;
+		unsigned int delivered;
+		unsigned int dropped;
+		unsigned int overlaps;
+		unsigned int reordered;
+	};
+
+	unsigned int nextRandom(unsigned int &seed) {
+		seed = seed * 1664525 + 1013904223;
+		return seed >> 16;
+	}
+
+	void spin(unsigned int iterations) {
+		volatile unsigned int sink = 0;
+		for (unsigned int i = 0; i < iterations; i++) {
+			sink += i;
+		}
+	}
+
+	Result runStress(Ring::DropPolicy policy, unsigned int frames, unsigned int consumerDelay) {
+		Ring ring;
+		ring.allocate(depth);
+		for (unsigned int i = 0; i < depth; i++) {
+			ring.getSlot(i).owner = NOBODY;
+		}
+
+		HANDLE stopEvent = CreateEvent(NULL, TRUE, FALSE, NULL);
+		std::atomic<bool> producing(true);
+
+		Result result = {};
+
+		std::thread consumer([&]() {
+			HANDLE handles[] = { ring.getReadEvent(), stopEvent };
+			unsigned int seed = 99;
+			bool first = true;
+			unsigned int last = 0;
+
+			for (;;) {
+				//Once the producer is done, one last pass drains the queue
+				bool done = !producing.load();
+
+				TestSlot *slot;
+				while ((slot = ring.beginRead()) != nullptr) {
+					if (slot->owner != NOBODY) {
+						result.overlaps++;
+					}
+					slot->owner = CONSUMER;
+
+					if (!first && slot->sequence <= last) {
+						result.reordered++;
+					}
+					first = false;
+					last = slot->sequence;
+					result.delivered++;
+
+					spin(nextRandom(seed) % consumerDelay);
+
+					slot->owner = NOBODY;
+					ring.endRead(slot);
+				}
+
+				if (done) {
+					break;
+				}
+				WaitForMultipleObjects(2, handles, FALSE, 1);
+			}
+		});
+
+		unsigned int seed = 7;
+		for (unsigned int i = 0; i < frames; i++) {
+			bool replaced;
+			TestSlot *slot = ring.beginWrite(policy, stopEvent, replaced);
+			result.produced++;
+			if (slot == nullptr) {
+				continue;
+			}
+
+			if (slot->owner == CONSUMER) {
+				result.overlaps++;
+			}
+			slot->owner = PRODUCER;
+			slot->sequence = i;
+
+			//Some copies fail, handing the slot back for the next frame
+			if (nextRandom(seed) % 16 == 0) {
+				slot->owner = NOBODY;
+				ring.abortWrite(slot, replaced);
+				continue;
+			}
+
+			slot->owner = NOBODY;
+			ring.commitWrite(slot);
+			if (!replaced) {
+				result.counted++;
+			}
+
+			spin(nextRandom(seed) % 2000);
+		}
+
+		producing.store(false);
+		consumer.join();
+
+		result.dropped = ring.getDroppedCount();
+		CloseHandle(stopEvent);
+		return result;
+	}
+
+	void checkResult(const Result &result, unsigned int frames) {
+		CHECK_EQUAL(frames, result.produced);
+		CHECK_EQUAL(0, result.overlaps);
+		CHECK_EQUAL(0, result.reordered);
+		//Every counted frame reaches the consumer, however it was dropped
+		CHECK_EQUAL(result.counted, result.delivered);
+		CHECK(result.delivered > 0);
+	}
+
+	void testDropOldest() {
+		const unsigned int frames = 20000;
+		Result result = runStress(Ring::DROP_OLDEST, frames, 20000);
+
+		checkResult(result, frames);
+		CHECK(result.dropped > 0);
+	}
+
+	void testDropNewest() {
+		const unsigned int frames = 20000;
+		Result result = runStress(Ring::DROP_NEWEST, frames, 20000);
+
+		checkResult(result, frames);
+		CHECK(result.dropped > 0);
+	}
+
+	void testBlock() {
+		const unsigned int frames = 5000;
+		Result result = runStress(Ring::BLOCK, frames, 20000);
+
+		checkResult(result, frames);
+		CHECK_EQUAL(0, result.dropped);
+	}
+
+	void testReplacedFlagSurvivesAbort() {
+		Ring ring;
+		ring.allocate(2);
+		bool replaced;
+
+		for (int i = 0; i < 2; i++) {
+			ring.commitWrite(ring.beginWrite(Ring::DROP_OLDEST, NULL, replaced));
+			CHECK(!replaced);
+		}
+
+		//A full ring gives back the oldest frame
+		TestSlot *slot = ring.beginWrite(Ring::DROP_OLDEST, NULL, replaced);
+		CHECK(slot == &ring.getSlot(0));
+		CHECK(replaced);
+		CHECK_EQUAL(1, ring.getDroppedCount());
+
+		ring.abortWrite(slot, replaced);
+		CHECK(ring.beginWrite(Ring::DROP_OLDEST, NULL, replaced) == slot);
+		CHECK(replaced);
+		ring.commitWrite(slot);
+
+		CHECK(ring.beginRead() == &ring.getSlot(1));
+		CHECK(ring.beginRead() == &ring.getSlot(0));
+		CHECK(ring.beginRead() == nullptr);
+		CHECK_EQUAL(2, ring.getHighWaterMark());
+
+		CHECK(ring.beginWrite(Ring::DROP_NEWEST, NULL, replaced) == nullptr);
+		CHECK(!replaced);
+		CHECK_EQUAL(2, ring.getDroppedCount());
+	}
+
+	//Frames the consumer fails to deliver count with those the policy drops
+	void testConsumerDrops() {
+		Ring ring;
+		ring.allocate(2);
+		bool replaced;
+
+		ring.commitWrite(ring.beginWrite(Ring::DROP_NEWEST, NULL, replaced));
+		TestSlot *slot = ring.beginRead();
+		ring.countDropped();
+		ring.endRead(slot);
+		CHECK_EQUAL(1, ring.getDroppedCount());
+
+		//The slot is free again
+		for (int i = 0; i < 2; i++) {
+			CHECK(ring.beginWrite(Ring::DROP_NEWEST, NULL, replaced) != nullptr);
+		}
+		CHECK_EQUAL(1, ring.getDroppedCount());
+	}
+}
+
+int main() {
+	testReplacedFlagSurvivesAbort();
+	testConsumerDrops();
+	testDropOldest();
+	testDropNewest();
+	testBlock();
+
+	return TEST_RESULT();
+}
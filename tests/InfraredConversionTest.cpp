@@ -0,0 +1,148 @@
+#include "../include/InfraredConversion.h"
+
+#include <cmath>
+#include <vector>
+
+#include "Check.h"
+
+namespace {
+	//Blend range of the merge, as in InfraredConversion.cpp
+	const float blendStart = 32768.0f;
+	const float blendEnd = 60000.0f;
+
+	unsigned int nextRandom(unsigned int &seed) {
+		seed = seed * 1664525 + 1013904223;
+		return seed >> 8;
+	}
+
+	//A scene seen by both exposures, the long one ratio times brighter and
+	//saturating. count is deliberately not a multiple of the vector width.
+	void makeScene(int count, float ratio, std::vector<UINT16> &shortExposure, std::vector<UINT16> &longExposure) {
+		unsigned int seed = 5;
+		shortExposure.resize(count);
+		longExposure.resize(count);
+
+		for (int i = 0; i < count; i++) {
+			float radiance = static_cast<float>(nextRandom(seed) % 60000);
+			float longValue = radiance * ratio;
+
+			shortExposure[i] = static_cast<UINT16>(radiance);
+			longExposure[i] = static_cast<UINT16>(longValue > 65535 ? 65535 : longValue);
+		}
+	}
+
+	float referenceMerge(UINT16 shortValue, UINT16 longValue, float ratio) {
+		float weight = (longValue - blendStart) / (blendEnd - blendStart);
+		weight = weight < 0 ? 0 : (weight > 1 ? 1 : weight);
+		return longValue + weight * (shortValue * ratio - longValue);
+	}
+
+	void testExposureRatio() {
+		std::vector<UINT16> shortExposure, longExposure;
+		makeScene(10007, 4.0f, shortExposure, longExposure);
+
+		float ratio = infraredconversion::exposureRatio(&shortExposure[0], &longExposure[0], 10007, 1.0f);
+		CHECK_NEAR(4.0, ratio, 0.01);
+
+		//Too few well exposed pixels keep the previous estimate
+		CHECK_NEAR(2.5, infraredconversion::exposureRatio(&shortExposure[0], &longExposure[0], 100, 2.5f), 0);
+	}
+
+	void testFloatMergeMatchesReference() {
+		const int count = 10007;
+		const float ratio = 6.0f;
+		std::vector<UINT16> shortExposure, longExposure;
+		makeScene(count, ratio, shortExposure, longExposure);
+
+		std::vector<float> hdr(count);
+		infraredconversion::mergeExposures(&shortExposure[0], &longExposure[0], count, ratio, &hdr[0]);
+
+		int mismatches = 0;
+		for (int i = 0; i < count; i++) {
+			float expected = referenceMerge(shortExposure[i], longExposure[i], ratio);
+			if (fabs(hdr[i] - expected) > expected * 1e-6f + 1e-3f) {
+				mismatches++;
+			}
+		}
+		CHECK_EQUAL(0, mismatches);
+	}
+
+	void testMono16MergeKeepsLongExposure() {
+		const int count = 10007;
+		const float ratio = 6.0f;
+		std::vector<UINT16> shortExposure, longExposure;
+		makeScene(count, ratio, shortExposure, longExposure);
+
+		std::vector<UINT16> hdr(count);
+		infraredconversion::mergeExposures(&shortExposure[0], &longExposure[0], count, ratio, &hdr[0]);
+
+		float scale = (65535.0f - blendStart) / (65535.0f * ratio - blendStart);
+		int unchanged = 0, changed = 0, mismatches = 0;
+		for (int i = 0; i < count; i++) {
+			float expected = referenceMerge(shortExposure[i], longExposure[i], ratio);
+			if (expected > blendStart) {
+				expected = blendStart + (expected - blendStart) * scale;
+			}
+			//Rounding, plus single precision error of the highlights
+			if (fabs(hdr[i] - expected) > 0.55f) {
+				mismatches++;
+			}
+
+			//Below the blend range every bit of the long exposure survives
+			if (longExposure[i] < blendStart) {
+				if (hdr[i] == longExposure[i]) {
+					unchanged++;
+				}
+				else {
+					changed++;
+				}
+			}
+		}
+		CHECK_EQUAL(0, mismatches);
+		CHECK_EQUAL(0, changed);
+		CHECK(unchanged > 0);
+
+		//The brightest merged value fills the range, in the vector path and
+		//the scalar tail alike
+		UINT16 brightShort[9], brightLong[9], bright[9];
+		for (int i = 0; i < 9; i++) {
+			brightShort[i] = 65535;
+			brightLong[i] = 65535;
+		}
+		infraredconversion::mergeExposures(brightShort, brightLong, 9, ratio, bright);
+		for (int i = 0; i < 9; i++) {
+			CHECK_EQUAL(65535, bright[i]);
+		}
+	}
+
+	void testMono16MergeIsMonotonic() {
+		const float ratio = 3.0f;
+		std::vector<UINT16> shortExposure(65536), longExposure(65536), hdr(65536);
+
+		//Radiance rising through the whole range of both exposures
+		for (int i = 0; i < 65536; i++) {
+			float longValue = i * ratio;
+			shortExposure[i] = static_cast<UINT16>(i);
+			longExposure[i] = static_cast<UINT16>(longValue > 65535 ? 65535 : longValue);
+		}
+		infraredconversion::mergeExposures(&shortExposure[0], &longExposure[0], 65536, ratio, &hdr[0]);
+
+		int decreases = 0;
+		for (int i = 1; i < 65536; i++) {
+			if (hdr[i] < hdr[i - 1]) {
+				decreases++;
+			}
+		}
+		CHECK_EQUAL(0, decreases);
+		CHECK_EQUAL(65535, hdr[65535]);
+	}
+}
+
+int main() {
+	testExposureRatio();
+	testFloatMergeMatchesReference();
+	testMono16MergeKeepsLongExposure();
+	testMono16MergeIsMonotonic();
+
+	return TEST_RESULT();
+}
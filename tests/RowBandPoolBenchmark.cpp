@@ -0,0 +1,64 @@
+#include "../include/ColourConversion.h"
+#include "../include/RowBandPool.h"
+
+#include <thread>
+#include <vector>
+
+#include "Benchmark.h"
+
+using namespace colourconversion;
+
+namespace {
+	const int colourWidth = 1920;
+	const int colourHeight = 1080;
+
+	//The colour adapter's band of an RGB24_1920x1080 frame
+	class ConvertRowsTask :
+		public RowBandPool::Task
+	{
+	public:
+		ConvertRowsTask(const BYTE *yuy2, BYTE *rgb, ConversionPath path) : m_yuy2(yuy2), m_rgb(rgb), m_path(path) {}
+
+		virtual void run(int first, int last) override {
+			convertYuy2ToRgb24(m_yuy2, colourWidth, BT601, 0, first, colourWidth, last - first,
+				m_rgb + first * colourWidth * 3, m_path);
+		}
+
+	private:
+		const BYTE *m_yuy2;
+		BYTE *m_rgb;
+		ConversionPath m_path;
+	};
+
+	//Full frames split across pools of one to eight threads; the scaling
+	//is bounded by the processors of the host
+	void benchmarkThreadCounts(const std::vector<BYTE> &yuy2, ConversionPath path, const char *pathName) {
+		std::vector<BYTE> rgb(colourWidth * colourHeight * 3);
+		ConvertRowsTask task(&yuy2[0], &rgb[0], path);
+
+		for (int threads = 1; threads <= 8; threads *= 2) {
+			RowBandPool pool(threads);
+
+			char name[64];
+			std::sprintf(name, "YUY2 to RGB24, %s, %d thread%s", pathName, threads, threads > 1 ? "s" : "");
+			benchmark::report(name, benchmark::time([&]() {
+				pool.run(task, colourHeight);
+			}), colourWidth * colourHeight);
+		}
+	}
+}
+
+int main() {
+	std::vector<BYTE> yuy2(colourWidth * colourHeight * 2);
+	unsigned int seed = 7;
+	for (size_t i = 0; i < yuy2.size(); i++) {
+		seed = seed * 1664525 + 1013904223;
+		yuy2[i] = static_cast<BYTE>(seed >> 8);
+	}
+
+	std::printf("%u logical processors\n", std::thread::hardware_concurrency());
+	benchmarkThreadCounts(yuy2, SCALAR_PATH, "scalar");
+	benchmarkThreadCounts(yuy2, AUTO_PATH, "vector");
+
+	return 0;
+}
@@ -0,0 +1,119 @@
+#include "../include/RowBandPool.h"
+
+#include <atomic>
+#include <vector>
+
+#include "Check.h"
+
+#ifndef _WIN32
+#include "compat/Win32CompatControl.h"
+#endif
+
+namespace {
+	class CountRowsTask :
+		public RowBandPool::Task
+	{
+	public:
+		CountRowsTask(int rows) : m_counts(rows) {
+			for (int i = 0; i < rows; i++) {
+				m_counts[i].store(0);
+			}
+		}
+
+		virtual void run(int first, int last) override {
+			for (int i = first; i < last; i++) {
+				m_counts[i]++;
+			}
+		}
+
+		//Rows not processed exactly once
+		int countErrors() const {
+			int errors = 0;
+			for (size_t i = 0; i < m_counts.size(); i++) {
+				if (m_counts[i].load() != 1) {
+					errors++;
+				}
+			}
+			return errors;
+		}
+
+	private:
+		std::vector<std::atomic<int> > m_counts;
+	};
+
+	void testEveryRowOnce() {
+		const int threadCounts[] = { 1, 2, 3, 8 };
+		const int rowCounts[] = { 0, 1, 5, 1080 };
+
+		for (int t = 0; t < 4; t++) {
+			RowBandPool pool(threadCounts[t]);
+			CHECK_EQUAL(threadCounts[t], pool.getThreadCount());
+
+			//The pool is reused frame after frame
+			for (int frame = 0; frame < 20; frame++) {
+				for (int r = 0; r < 4; r++) {
+					CountRowsTask task(rowCounts[r]);
+					pool.run(task, rowCounts[r]);
+					CHECK_EQUAL(0, task.countErrors());
+				}
+			}
+		}
+	}
+
+	void testThreadCountFromAffinity() {
+		DWORD_PTR mask = 0x16;
+		RowBandPool pool(0, mask);
+
+		CHECK_EQUAL(3, pool.getThreadCount());
+		CHECK(pool.getAffinityMask() == mask);
+
+		CountRowsTask task(100);
+		pool.run(task, 100);
+		CHECK_EQUAL(0, task.countErrors());
+	}
+
+#ifndef _WIN32
+	//Workers that fail to start leave fewer bands instead of a pool that
+	//waits for them forever
+	void testWorkersFailingToStart() {
+		win32compat::failCreateThreadAfter(2);
+		RowBandPool pool(6);
+		win32compat::failCreateThreadAfter(-1);
+
+		CHECK_EQUAL(3, pool.getThreadCount());
+
+		CountRowsTask task(1080);
+		pool.run(task, 1080);
+		CHECK_EQUAL(0, task.countErrors());
+
+		win32compat::failCreateThreadAfter(0);
+		RowBandPool single(4);
+		win32compat::failCreateThreadAfter(-1);
+
+		CHECK_EQUAL(1, single.getThreadCount());
+		CountRowsTask singleTask(10);
+		single.run(singleTask, 10);
+		CHECK_EQUAL(0, singleTask.countErrors());
+	}
+#endif
+
+	void testDefaultUsesEveryProcessor() {
+		SYSTEM_INFO info;
+		GetSystemInfo(&info);
+
+		RowBandPool pool;
+		CHECK_EQUAL(info.dwNumberOfProcessors > MAXIMUM_WAIT_OBJECTS ? MAXIMUM_WAIT_OBJECTS : info.dwNumberOfProcessors,
+			pool.getThreadCount());
+	}
+}
+
+int main() {
+	testEveryRowOnce();
+	testThreadCountFromAffinity();
+#ifndef _WIN32
+	testWorkersFailingToStart();
+#endif
+	testDefaultUsesEveryProcessor();
+
+	return TEST_RESULT();
+}
@@ -0,0 +1,161 @@
+#include "../include/SensorClock.h"
+
+#include <cmath>
+#include <vector>
+
+#include "Check.h"
+
+namespace {
+	const double ticksPerSecond = 10000000.0;
+
+	const int depthStream = 8;
+	const int colourStream = 1;
+
+	//A synthetic sensor: host time runs fast of sensor time by drift, and
+	//each stream's frames reach the host after a fixed latency plus jitter.
+	struct SyntheticSensor {
+		double drift;
+		double hostStart;
+		unsigned int seed;
+
+		double hostTime(double sensorSeconds, double latency, double jitter) {
+			seed = seed * 1664525 + 1013904223;
+			double noise = (static_cast<double>(seed >> 8) / (1 << 24) - 0.5) * 2 * jitter;
+			return hostStart + sensorSeconds * (1 + drift) + latency + noise;
+		}
+	};
+
+	TIMESPAN toTicks(double seconds) {
+		return static_cast<TIMESPAN>(seconds * ticksPerSecond + 0.5);
+	}
+
+	void testSingleStreamFollowsDrift() {
+		SensorClock clock;
+		SyntheticSensor sensor = {50e-6, 1000.0, 1};
+
+		for (int i = 0; i < 3000; i++) {
+			double seconds = 5.0 + i / 30.0;
+			clock.update(depthStream, toTicks(seconds), sensor.hostTime(seconds, 0.02, 0.002));
+		}
+
+		CHECK_EQUAL(3000, clock.getSampleCount());
+		CHECK_NEAR(50e-6, clock.getDrift(), 20e-6);
+		CHECK(clock.getJitter() < 0.002);
+		CHECK_NEAR(1000.0 + 200 * (1 + 50e-6) + 0.02, clock.map(toTicks(200.0)), 0.001);
+	}
+
+	void testStreamsOutOfOrderShareOneMapping() {
+		SensorClock clock;
+		SyntheticSensor sensor = {-30e-6, 50.0, 7};
+
+		//Colour frames take 40 ms longer than depth frames to arrive, so a
+		//colour frame often reaches the clock after a later depth frame
+		int updates = 0;
+		for (int i = 0; i < 3000; i++) {
+			double depthSeconds = 1.0 + i / 30.0;
+			double colourSeconds = depthSeconds - 0.011;
+
+			clock.update(depthStream, toTicks(depthSeconds), sensor.hostTime(depthSeconds, 0.02, 0.003));
+			clock.update(colourStream, toTicks(colourSeconds), sensor.hostTime(colourSeconds, 0.06, 0.003));
+			updates += 2;
+		}
+
+		//No sample restarted the fit
+		CHECK_EQUAL(updates, clock.getSampleCount());
+
+		CHECK_NEAR(0.0, clock.getLatency(depthStream), 1e-12);
+		CHECK_NEAR(0.04, clock.getLatency(colourStream), 0.001);
+		CHECK_NEAR(-30e-6, clock.getDrift(), 20e-6);
+		CHECK(clock.getJitter() < 0.003);
+
+		//Mapped on the depth stream's line, whichever stream stamps them
+		double seconds = 90.0;
+		CHECK_NEAR(50.0 + seconds * (1 - 30e-6) + 0.02, clock.map(toTicks(seconds)), 0.001);
+
+		double depthTime = clock.update(depthStream, toTicks(seconds), sensor.hostTime(seconds, 0.02, 0.003));
+		double colourTime = clock.update(colourStream, toTicks(seconds), sensor.hostTime(seconds, 0.06, 0.003));
+		CHECK_NEAR(depthTime, colourTime, 0.0005);
+	}
+
+	//RMS distance of errors from their mean, in seconds; a constant offset
+	//does not disturb the alignment of frames
+	double rmsAboutMean(const double *errors, int count) {
+		double mean = 0, squares = 0;
+		for (int i = 0; i < count; i++) {
+			mean += errors[i];
+		}
+		mean /= count;
+		for (int i = 0; i < count; i++) {
+			squares += (errors[i] - mean) * (errors[i] - mean);
+		}
+		return sqrt(squares / count);
+	}
+
+	//The jitter figures of the sensor clock: a 30 fps trace with 50 ppm
+	//drift whose frames arrive after 20 ms plus an exponential delay with a
+	//4 ms mean. Both errors are measured against the true frame times over
+	//the last minute, once the fit has settled.
+	void testJitterBeforeAndAfter() {
+		const int frames = 9000;
+		const int measured = 1800;
+		const double drift = 50e-6;
+		SensorClock clock;
+		unsigned int seed = 11;
+
+		std::vector<double> raw(measured), mapped(measured);
+		for (int i = 0; i < frames; i++) {
+			double seconds = i / 30.0;
+			double trueTime = 20.0 + seconds * (1 + drift);
+
+			seed = seed * 1664525 + 1013904223;
+			double uniform = (static_cast<double>(seed >> 8) + 0.5) / (1 << 24);
+			double arrival = trueTime + 0.02 - 0.004 * log(uniform);
+
+			double time = clock.update(depthStream, toTicks(seconds), arrival);
+			if (i >= frames - measured) {
+				raw[i - (frames - measured)] = arrival - trueTime;
+				mapped[i - (frames - measured)] = time - trueTime;
+			}
+		}
+
+		double rawJitter = rmsAboutMean(&raw[0], measured);
+		double mappedJitter = rmsAboutMean(&mapped[0], measured);
+		std::printf("jitter: %.3f ms raw, %.3f ms mapped\n", rawJitter * 1000, mappedJitter * 1000);
+
+		CHECK_NEAR(0.004, rawJitter, 0.0005);
+		CHECK(mappedJitter < rawJitter / 10);
+	}
+
+	void testJumpRestartsMapping() {
+		SensorClock clock;
+		SyntheticSensor sensor = {0, 10.0, 3};
+
+		for (int i = 0; i < 300; i++) {
+			double seconds = i / 30.0;
+			clock.update(depthStream, toTicks(seconds), sensor.hostTime(seconds, 0.02, 0.001));
+			clock.update(colourStream, toTicks(seconds), sensor.hostTime(seconds, 0.06, 0.001));
+		}
+		CHECK_EQUAL(600, clock.getSampleCount());
+
+		//The sensor was reopened and its clock started again from zero
+		sensor.hostStart = 100.0;
+		double time = clock.update(colourStream, toTicks(0.5), sensor.hostTime(0.5, 0.06, 0));
+
+		CHECK_EQUAL(1, clock.getSampleCount());
+		CHECK_NEAR(100.56, time, 1e-6);
+		CHECK_NEAR(0.0, clock.getLatency(colourStream), 1e-12);
+
+		clock.reset();
+		CHECK_EQUAL(0, clock.getSampleCount());
+		CHECK_NEAR(0.0, clock.getDrift(), 1e-12);
+	}
+}
+
+int main() {
+	testSingleStreamFollowsDrift();
+	testStreamsOutOfOrderShareOneMapping();
+	testJitterBeforeAndAfter();
+	testJumpRestartsMapping();
+
+	return TEST_RESULT();
+}
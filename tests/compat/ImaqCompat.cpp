@@ -0,0 +1,81 @@
+#include <mwadaptorimaq.h>
+
+#include <cstdlib>
+#include <mutex>
+
+//The imaqkit allocator and critical sections the portable sources use, in
+//place of the ones the image acquisition engine exports
+namespace {
+	class CriticalSection :
+		public imaqkit::ICriticalSection
+	{
+	public:
+		virtual void enter(void) override {
+			m_mutex.lock();
+		}
+
+		virtual void leave(void) override {
+			m_mutex.unlock();
+		}
+
+	private:
+		std::recursive_mutex m_mutex;
+	};
+
+	class AutoCriticalSection :
+		public imaqkit::IAutoCriticalSection
+	{
+	public:
+		AutoCriticalSection(imaqkit::ICriticalSection *section, bool enter)
+			:m_section(section),
+			m_entered(false) {
+			if (enter) {
+				this->enter();
+			}
+		}
+
+		virtual ~AutoCriticalSection() {
+			leave();
+		}
+
+		virtual void enter(void) override {
+			if (!m_entered) {
+				m_section->enter();
+				m_entered = true;
+			}
+		}
+
+		virtual void leave(void) override {
+			if (m_entered) {
+				m_section->leave();
+				m_entered = false;
+			}
+		}
+
+		virtual bool getState(void) override {
+			return m_entered;
+		}
+
+	private:
+		imaqkit::ICriticalSection *m_section;
+		bool m_entered;
+	};
+}
+
+namespace imaqkit {
+	void *imaqmalloc(size_t len) {
+		return malloc(len);
+	}
+
+	void imaqfree(void *ptr) {
+		free(ptr);
+	}
+
+	ICriticalSection *createCriticalSection(void) {
+		return new CriticalSection();
+	}
+
+	IAutoCriticalSection *createAutoCriticalSection(ICriticalSection *section, bool enter) {
+		return new AutoCriticalSection(section, enter);
+	}
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+//The Kinect SDK types used by the portable sources, for building the unit
+//tests without the SDK.
+
+#include <windows.h>
+
+typedef INT64 TIMESPAN;
+
+typedef struct _PointF {
+	float X;
+	float Y;
+} PointF;
+
+typedef struct _ColorSpacePoint {
+	float X;
+	float Y;
+} ColorSpacePoint;
+
+typedef struct _DepthSpacePoint {
+	float X;
+	float Y;
+} DepthSpacePoint;
+
+typedef struct _CameraSpacePoint {
+	float X;
+	float Y;
+	float Z;
+} CameraSpacePoint;
+
+#define BODY_COUNT 6
+
+enum JointType {
+	JointType_SpineBase = 0,
+	JointType_Count = 25
+};
+
+enum HandState {
+	HandState_Unknown = 0,
+	HandState_NotTracked = 1,
+	HandState_Open = 2,
+	HandState_Closed = 3,
+	HandState_Lasso = 4
+};
+
+enum TrackingState {
+	TrackingState_NotTracked = 0,
+	TrackingState_Inferred = 1,
+	TrackingState_Tracked = 2
+};
+
+typedef struct _Vector4 {
+	float x;
+	float y;
+	float z;
+	float w;
+} Vector4;
+
+typedef struct _Joint {
+	enum JointType JointType;
+	CameraSpacePoint Position;
+	enum TrackingState TrackingState;
+} Joint;
+
+typedef struct _JointOrientation {
+	enum JointType JointType;
+	Vector4 Orientation;
+} JointOrientation;
+
+//Only the body accessors BodyFrameData reads
+struct IBody {
+	virtual HRESULT GetJoints(UINT capacity, Joint *joints) = 0;
+	virtual HRESULT GetJointOrientations(UINT capacity, JointOrientation *jointOrientations) = 0;
+	virtual HRESULT get_IsTracked(BOOLEAN *tracked) = 0;
+	virtual HRESULT get_TrackingId(UINT64 *trackingId) = 0;
+	virtual HRESULT get_HandLeftState(HandState *handState) = 0;
+	virtual HRESULT get_HandRightState(HandState *handState) = 0;
+
+protected:
+	~IBody() {}
+};
@@ -0,0 +1,241 @@
+#include <windows.h>
+
+#include "Win32CompatControl.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <mutex>
+#include <thread>
+
+//Events and threads are waitable objects behind one lock, which is plenty
+//for tests
+namespace {
+	struct WaitObject {
+		bool manualReset;
+		bool signalled;
+		//A thread's object is shared by its handle and the thread itself
+		int references;
+	};
+
+	std::mutex waitLock;
+	std::condition_variable waitChanged;
+
+	//Successful CreateThread calls left, or -1 for no limit
+	int threadsLeft = -1;
+
+	WaitObject *toObject(HANDLE handle) {
+		return static_cast<WaitObject*>(handle);
+	}
+
+	void release(WaitObject *object) {
+		if (--object->references == 0) {
+			delete object;
+		}
+	}
+
+	bool isSignalled(DWORD count, const HANDLE *handles, BOOL waitAll, DWORD *index) {
+		for (DWORD i = 0; i < count; i++) {
+			bool signalled = toObject(handles[i])->signalled;
+			if (signalled && !waitAll) {
+				*index = i;
+				return true;
+			}
+			if (!signalled && waitAll) {
+				return false;
+			}
+		}
+
+		*index = 0;
+		return waitAll != FALSE;
+	}
+
+	void consume(WaitObject *object) {
+		if (!object->manualReset) {
+			object->signalled = false;
+		}
+	}
+}
+
+HANDLE CreateEvent(void *, BOOL manualReset, BOOL initialState, const char *) {
+	WaitObject *object = new WaitObject();
+	object->manualReset = manualReset != FALSE;
+	object->signalled = initialState != FALSE;
+	object->references = 1;
+	return object;
+}
+
+BOOL SetEvent(HANDLE event) {
+	std::lock_guard<std::mutex> guard(waitLock);
+	toObject(event)->signalled = true;
+	waitChanged.notify_all();
+	return TRUE;
+}
+
+BOOL ResetEvent(HANDLE event) {
+	std::lock_guard<std::mutex> guard(waitLock);
+	toObject(event)->signalled = false;
+	return TRUE;
+}
+
+void win32compat::failCreateThreadAfter(int count) {
+	std::lock_guard<std::mutex> guard(waitLock);
+	threadsLeft = count;
+}
+
+HANDLE CreateThread(void *, SIZE_T, LPTHREAD_START_ROUTINE start, void *param, DWORD, DWORD *) {
+	{
+		std::lock_guard<std::mutex> guard(waitLock);
+		if (threadsLeft == 0) {
+			return NULL;
+		}
+		if (threadsLeft > 0) {
+			threadsLeft--;
+		}
+	}
+
+	WaitObject *object = new WaitObject();
+	object->manualReset = true;
+	object->signalled = false;
+	object->references = 2;
+
+	std::thread([object, start, param]() {
+		start(param);
+
+		std::lock_guard<std::mutex> guard(waitLock);
+		object->signalled = true;
+		waitChanged.notify_all();
+		release(object);
+	}).detach();
+
+	return object;
+}
+
+DWORD WaitForSingleObject(HANDLE handle, DWORD milliseconds) {
+	return WaitForMultipleObjects(1, &handle, TRUE, milliseconds);
+}
+
+DWORD WaitForMultipleObjects(DWORD count, const HANDLE *handles, BOOL waitAll, DWORD milliseconds) {
+	std::unique_lock<std::mutex> guard(waitLock);
+	DWORD index;
+
+	std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(milliseconds);
+	while (!isSignalled(count, handles, waitAll, &index)) {
+		if (milliseconds == INFINITE) {
+			waitChanged.wait(guard);
+		}
+		else if (waitChanged.wait_until(guard, deadline) == std::cv_status::timeout) {
+			if (!isSignalled(count, handles, waitAll, &index)) {
+				return WAIT_TIMEOUT;
+			}
+			break;
+		}
+	}
+
+	if (waitAll) {
+		for (DWORD i = 0; i < count; i++) {
+			consume(toObject(handles[i]));
+		}
+	}
+	else {
+		consume(toObject(handles[index]));
+	}
+	return WAIT_OBJECT_0 + index;
+}
+
+BOOL CloseHandle(HANDLE handle) {
+	std::lock_guard<std::mutex> guard(waitLock);
+	release(toObject(handle));
+	return TRUE;
+}
+
+HANDLE GetCurrentThread() {
+	//A pseudo handle, as on Windows
+	return reinterpret_cast<HANDLE>(-2);
+}
+
+DWORD_PTR SetThreadAffinityMask(HANDLE, DWORD_PTR) {
+	//Pinning is not emulated; report an all-processor previous mask
+	return ~static_cast<DWORD_PTR>(0);
+}
+
+void GetSystemInfo(SYSTEM_INFO *info) {
+	unsigned int processors = std::thread::hardware_concurrency();
+	info->dwNumberOfProcessors = processors == 0 ? 1 : processors;
+}
+
+void Sleep(DWORD milliseconds) {
+	std::this_thread::sleep_for(std::chrono::milliseconds(milliseconds));
+}
+
+void InitializeCriticalSection(CRITICAL_SECTION *section) {
+	section->mutex = new std::recursive_mutex();
+}
+
+void DeleteCriticalSection(CRITICAL_SECTION *section) {
+	delete static_cast<std::recursive_mutex*>(section->mutex);
+	section->mutex = nullptr;
+}
+
+void EnterCriticalSection(CRITICAL_SECTION *section) {
+	static_cast<std::recursive_mutex*>(section->mutex)->lock();
+}
+
+void LeaveCriticalSection(CRITICAL_SECTION *section) {
+	static_cast<std::recursive_mutex*>(section->mutex)->unlock();
+}
+
+DWORD GetLastError() {
+	return ERROR_SUCCESS;
+}
+
+HANDLE GetCurrentProcess() {
+	return reinterpret_cast<HANDLE>(-1);
+}
+
+BOOL OpenProcessToken(HANDLE, DWORD, HANDLE *) {
+	return FALSE;
+}
+
+BOOL LookupPrivilegeValue(const char *, const char *, LUID *) {
+	return FALSE;
+}
+
+BOOL AdjustTokenPrivileges(HANDLE, BOOL, TOKEN_PRIVILEGES *, DWORD, TOKEN_PRIVILEGES *, DWORD *) {
+	return FALSE;
+}
+
+BOOL QueryPerformanceCounter(LARGE_INTEGER *count) {
+	count->QuadPart = std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()).count();
+	return TRUE;
+}
+
+BOOL QueryPerformanceFrequency(LARGE_INTEGER *frequency) {
+	frequency->QuadPart = 1000000000;
+	return TRUE;
+}
+
+SIZE_T GetLargePageMinimum() {
+	return 0;
+}
+
+void *VirtualAlloc(void *, SIZE_T, DWORD, DWORD) {
+	return NULL;
+}
+
+BOOL VirtualFree(void *, SIZE_T, DWORD) {
+	return FALSE;
+}
+
+void *_aligned_malloc(size_t size, size_t alignment) {
+	void *block = NULL;
+	if (posix_memalign(&block, alignment, size) != 0) {
+		return NULL;
+	}
+	return block;
+}
+
+void _aligned_free(void *block) {
+	free(block);
+}
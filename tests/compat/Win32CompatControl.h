@@ -0,0 +1,7 @@
+#pragma once
+
+//Fault injection for the Win32 shim, so tests can reach the failure paths
+namespace win32compat {
+	//CreateThread succeeds count more times, then fails until reset with -1
+	void failCreateThreadAfter(int count);
+}
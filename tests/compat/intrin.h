@@ -0,0 +1,16 @@
+#pragma once
+
+//MSVC's processor feature intrinsics. cpuid.h is left out: recent versions
+//declare some of these themselves, with other signatures.
+
+#include <immintrin.h>
+
+inline void __cpuidex(int info[4], int leaf, int subleaf) {
+	__asm__ __volatile__("cpuid"
+		: "=a"(info[0]), "=b"(info[1]), "=c"(info[2]), "=d"(info[3])
+		: "a"(leaf), "c"(subleaf));
+}
+
+inline void __cpuid(int info[4], int leaf) {
+	__cpuidex(info, leaf, 0);
+}
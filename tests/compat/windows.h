@@ -0,0 +1,126 @@
+#pragma once
+
+//The subset of the Win32 API used by the portable sources, for building the
+//unit tests off Windows. Implemented in Win32Compat.cpp.
+
+#include <cstddef>
+#include <cstdint>
+
+typedef int32_t HRESULT;
+typedef uint8_t BYTE;
+typedef uint16_t UINT16;
+typedef uint32_t UINT32;
+typedef unsigned int UINT;
+typedef uint32_t DWORD;
+typedef int64_t INT64;
+typedef uint64_t UINT64;
+typedef int64_t LONGLONG;
+typedef int32_t LONG;
+typedef int BOOL;
+typedef unsigned char BOOLEAN;
+typedef uintptr_t DWORD_PTR;
+typedef size_t SIZE_T;
+typedef void *HANDLE;
+
+typedef union {
+	struct {
+		DWORD LowPart;
+		LONG HighPart;
+	};
+	LONGLONG QuadPart;
+} LARGE_INTEGER;
+
+#define WINAPI
+
+#define TRUE 1
+#define FALSE 0
+
+#define FAILED(hr) ((HRESULT)(hr) < 0)
+#define SUCCEEDED(hr) ((HRESULT)(hr) >= 0)
+#define S_OK ((HRESULT)0)
+#define E_FAIL ((HRESULT)0x80004005)
+#define E_OUTOFMEMORY ((HRESULT)0x8007000E)
+#define E_PENDING ((HRESULT)0x8000000A)
+
+#define INFINITE 0xFFFFFFFF
+#define WAIT_OBJECT_0 0
+#define WAIT_TIMEOUT 258
+#define WAIT_FAILED 0xFFFFFFFF
+#define MAXIMUM_WAIT_OBJECTS 64
+
+#define ERROR_SUCCESS 0L
+
+#define MEM_COMMIT 0x1000
+#define MEM_RESERVE 0x2000
+#define MEM_RELEASE 0x8000
+#define MEM_LARGE_PAGES 0x20000000
+#define PAGE_READWRITE 0x04
+
+typedef struct {
+	DWORD dwNumberOfProcessors;
+} SYSTEM_INFO;
+
+typedef struct {
+	DWORD LowPart;
+	LONG HighPart;
+} LUID;
+
+typedef struct {
+	LUID Luid;
+	DWORD Attributes;
+} LUID_AND_ATTRIBUTES;
+
+typedef struct {
+	DWORD PrivilegeCount;
+	LUID_AND_ATTRIBUTES Privileges[1];
+} TOKEN_PRIVILEGES;
+
+#define TOKEN_ADJUST_PRIVILEGES 0x0020
+#define TOKEN_QUERY 0x0008
+#define SE_PRIVILEGE_ENABLED 0x00000002L
+#define SE_LOCK_MEMORY_NAME "SeLockMemoryPrivilege"
+
+typedef DWORD (WINAPI *LPTHREAD_START_ROUTINE)(void *param);
+
+//Recursive like the real one
+typedef struct {
+	void *mutex;
+} CRITICAL_SECTION;
+
+HANDLE CreateEvent(void *attributes, BOOL manualReset, BOOL initialState, const char *name);
+BOOL SetEvent(HANDLE event);
+BOOL ResetEvent(HANDLE event);
+HANDLE CreateThread(void *attributes, SIZE_T stackSize, LPTHREAD_START_ROUTINE start, void *param,
+	DWORD flags, DWORD *threadId);
+DWORD WaitForSingleObject(HANDLE handle, DWORD milliseconds);
+DWORD WaitForMultipleObjects(DWORD count, const HANDLE *handles, BOOL waitAll, DWORD milliseconds);
+BOOL CloseHandle(HANDLE handle);
+HANDLE GetCurrentThread();
+DWORD_PTR SetThreadAffinityMask(HANDLE thread, DWORD_PTR mask);
+void GetSystemInfo(SYSTEM_INFO *info);
+void Sleep(DWORD milliseconds);
+
+void InitializeCriticalSection(CRITICAL_SECTION *section);
+void DeleteCriticalSection(CRITICAL_SECTION *section);
+void EnterCriticalSection(CRITICAL_SECTION *section);
+void LeaveCriticalSection(CRITICAL_SECTION *section);
+DWORD GetLastError();
+
+//No privileges are ever granted
+HANDLE GetCurrentProcess();
+BOOL OpenProcessToken(HANDLE process, DWORD access, HANDLE *token);
+BOOL LookupPrivilegeValue(const char *system, const char *name, LUID *luid);
+BOOL AdjustTokenPrivileges(HANDLE token, BOOL disableAll, TOKEN_PRIVILEGES *newState, DWORD length,
+	TOKEN_PRIVILEGES *previousState, DWORD *returnLength);
+
+BOOL QueryPerformanceCounter(LARGE_INTEGER *count);
+BOOL QueryPerformanceFrequency(LARGE_INTEGER *frequency);
+
+//There are no large pages here, so VirtualAlloc only backs the fallback
+//path of callers that try them
+SIZE_T GetLargePageMinimum();
+void *VirtualAlloc(void *address, SIZE_T size, DWORD type, DWORD protect);
+BOOL VirtualFree(void *address, SIZE_T size, DWORD type);
+
+void *_aligned_malloc(size_t size, size_t alignment);
+void _aligned_free(void *block);